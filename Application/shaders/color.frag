@@ -4,6 +4,7 @@
 layout (location = 0) in  vec4 in_position;
 layout (location = 1) in  vec2 uv;
 layout (location = 2) in flat uint normal_index;
+layout (location = 3) in flat uint block_type;
 layout (location = 0) out vec4 fragColor;
 
 layout (push_constant) uniform A {
@@ -13,7 +14,6 @@ layout (push_constant) uniform A {
 } u;
 
 layout (set = 0, binding = 0) uniform sampler2D atlas;
-layout (set = 1, binding = 0) uniform usampler3D block_types;
 
 vec3 hsv2rgb(vec3 c)
 {
@@ -40,8 +40,8 @@ const vec2[6] atlas_offsets = vec2[6] (
 );
 const vec2 atlas_size = vec2(16.0) / vec2(128.0,96.0);
 
-const float[6] spec_map = float[6] (
-    1.0, 0.0, 0.5, 0.25, 0.0, 1.0
+const float[8] spec_map = float[8] (
+    1.0, 0.0, 0.5, 0.25, 0.0, 1.0, 0.0, 0.5
 );
 
 void main() {
@@ -56,9 +56,7 @@ void main() {
 #elif 1
     vec3 normal = normal_map[normal_index];
     float diffuse = max(0.0,dot(-u.light_direction, normal));
-    vec3 inside = in_position.xyz - normal * 0.5;
-    inside.x = 0; inside.z = 0; // TODO: delete me
-    uint index = texelFetch(block_types, ivec3(inside), 0).r & 7;
+    uint index = block_type & 7; // one atlas column per type
     vec3 object_color = texture(atlas, vec2(float(index) * 16.0/128.0, atlas_offsets[normal_index].y) + fract(uv) * atlas_size).rgb;
     float ambient = 0.05;
     
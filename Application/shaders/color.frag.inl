@@ -1,62 +1,86 @@
 /*
     Generated with file_to_cpp by Lazergenix
 */
-static constexpr unsigned int size = 4224;
+static constexpr unsigned int size = 3812;
 static constexpr unsigned int data[] = {
-119734787,65536,851979,172,0,131089,1,393227,1,1280527431,1685353262,808793134,
-0,196622,0,1,589839,4,4,1852399981,0,24,47,108,157,196624,4,7,196611,2,450,655364,1197427783,
-1279741775,1885560645,1953718128,1600482425,1701734764,1919509599,1769235301,
-25974,524292,1197427783,1279741775,1852399429,1685417059,1768185701,1952671090,
-6649449,262149,4,1852399981,0,262149,9,1836216174,27745,393221,24,1836216174,
-1767861345,2019910766,0,327685,27,1701080681,1818386808,101,262149,31,1717987684,
-6648693,196613,32,65,458758,32,0,1751607660,1768185716,1952671090,7237481,458758,
-32,1,1600485733,1769172848,1852795252,0,196613,34,117,262149,44,1769172585,25956,
-327685,47,1885302377,1953067887,7237481,262149,59,1701080681,120,327685,63,
-1668246626,2037669739,7562608,393221,74,1701470831,1667200099,1919904879,
-0,262149,78,1634497633,115,327685,103,1701080681,1818386808,101,196613,108,30325,
-262149,117,1768058209,7630437,327685,119,1667592307,1918987381,0,327685,120,
-1953654102,1867806821,6650181,393221,128,1751607628,1717916276,1952671084,
-0,393221,134,1667592275,1918987381,1952670022,29295,327685,151,1701080681,1818386808,
-101,327685,157,1734439526,1869377347,114,196679,24,14,262215,24,30,2,327752,32,
-0,35,80,327752,32,1,35,96,196679,32,2,262215,47,30,0,262215,63,34,1,262215,63,33,0,262215,78,
-34,0,262215,78,33,0,262215,108,30,1,262215,157,30,0,131091,2,196641,3,2,196630,6,32,262167,
-7,6,3,262176,8,7,7,262165,10,32,0,262187,10,11,6,262172,12,7,11,262187,6,13,1065353216,262187,
-6,14,0,393260,7,15,13,14,14,393260,7,16,14,13,14,393260,7,17,14,14,13,262187,6,18,3212836864,
-393260,7,19,18,14,14,393260,7,20,14,18,14,393260,7,21,14,14,18,589868,12,22,15,16,17,19,20,
-21,262176,23,1,10,262203,23,24,1,262176,26,7,12,262176,30,7,6,262174,32,7,7,262176,33,9,
-32,262203,33,34,9,262165,35,32,1,262187,35,36,0,262176,37,9,7,262167,45,6,4,262176,46,1,45,
-262203,46,47,1,262187,6,51,1056964608,262187,10,54,0,262187,10,56,2,262176,58,7,10,589849,
-60,10,2,0,0,0,1,0,196635,61,60,262176,62,0,61,262203,62,63,0,262167,66,35,3,262167,69,10,4,262187,
-10,72,7,589849,75,6,1,0,0,0,1,0,196635,76,75,262176,77,0,76,262203,77,78,0,262187,6,82,1098907648,
-262187,6,84,1124073472,262167,86,6,2,262172,87,86,11,262187,6,88,1061158912,327724,
-86,89,88,14,262187,6,90,1051372203,327724,86,91,88,90,262187,6,92,1042983595,327724,
-86,93,88,92,327724,86,94,88,51,262187,6,95,1062557013,327724,86,96,88,95,262187,6,97,
-1059760811,327724,86,98,88,97,589868,87,99,89,91,93,94,96,98,262187,10,101,1,262176,
-102,7,87,262176,107,1,86,262203,107,108,1,262187,6,111,1040187392,327724,86,112,111,
-92,262187,6,118,1028443341,262187,35,121,1,131092,139,262187,6,144,1107296256,262172,
-146,6,11,262187,6,147,1048576000,589868,146,148,13,14,51,147,14,13,262176,150,7,146,
-262176,156,3,45,262203,156,157,3,393260,7,163,14,13,13,327734,2,4,0,3,131320,5,262203,8,
-9,7,262203,26,27,7,262203,30,31,7,262203,8,44,7,262203,58,59,7,262203,8,74,7,262203,102,
-103,7,262203,30,117,7,262203,30,119,7,262203,8,120,7,262203,8,128,7,262203,30,134,7,262203,
-150,151,7,262205,10,25,24,196670,27,22,327745,8,28,27,25,262205,7,29,28,196670,9,29,327745,
-37,38,34,36,262205,7,39,38,262271,7,40,39,262205,7,41,9,327828,6,42,40,41,458764,6,43,1,40,
-14,42,196670,31,43,262205,45,48,47,524367,7,49,48,48,0,1,2,262205,7,50,9,327822,7,52,50,51,
-327811,7,53,49,52,196670,44,53,327745,30,55,44,54,196670,55,14,327745,30,57,44,56,196670,
-57,14,262205,61,64,63,262205,7,65,44,262254,66,67,65,262244,60,68,64,458847,69,70,68,67,
-2,36,327761,10,71,70,0,327879,10,73,71,72,196670,59,73,262205,76,79,78,262205,10,80,59,262256,
-6,81,80,327813,6,83,81,82,327816,6,85,83,84,262205,10,100,24,196670,103,99,393281,30,104,
-103,100,101,262205,6,105,104,327760,86,106,85,105,262205,86,109,108,393228,86,110,1,
-10,109,327813,86,113,110,112,327809,86,114,106,113,327767,45,115,79,114,524367,7,116,
-115,115,0,1,2,196670,74,116,196670,117,118,196670,119,14,327745,37,122,34,121,262205,
-7,123,122,262205,45,124,47,524367,7,125,124,124,0,1,2,327811,7,126,123,125,393228,7,127,
-1,69,126,196670,120,127,327745,37,129,34,36,262205,7,130,129,262205,7,131,9,458764,7,
-132,1,71,130,131,393228,7,133,1,69,132,196670,128,133,262205,7,135,120,262205,7,136,128,
-327828,6,137,135,136,196670,134,137,262205,6,138,134,327866,139,140,138,14,196855,
-142,0,262394,140,141,142,131320,141,262205,6,143,134,458764,6,145,1,26,143,144,196670,
-134,145,262205,10,149,59,196670,151,148,327745,30,152,151,149,262205,6,153,152,262205,
-6,154,134,327813,6,155,153,154,196670,119,155,131321,142,131320,142,262205,6,158,31,
-262205,6,159,117,327809,6,160,158,159,393296,7,161,160,160,160,262205,6,162,119,327822,
-7,164,163,162,327809,7,165,161,164,262205,7,166,74,327813,7,167,165,166,327761,6,168,
-167,0,327761,6,169,167,1,327761,6,170,167,2,458832,45,171,168,169,170,13,196670,157,171,
-65789,65592,
+119734787,65536,851979,175,0,131089,1,393227,1,1280527431,1685353262,808793134,
+0,196622,0,1,655375,4,4,1852399981,0,24,47,108,
+157,172,196624,4,7,196611,2,450,655364,1197427783,1279741775,1885560645,
+1953718128,1600482425,1701734764,1919509599,1769235301,25974,524292,1197427783,1279741775,1852399429,1685417059,1768185701,
+1952671090,6649449,262149,4,1852399981,0,262149,9,1836216174,27745,393221,24,
+1836216174,1767861345,2019910766,0,327685,172,1668246626,2037669739,25968,327685,27,1701080681,
+1818386808,101,262149,31,1717987684,6648693,196613,32,65,458758,32,0,
+1751607660,1768185716,1952671090,7237481,458758,32,1,1600485733,1769172848,1852795252,0,196613,
+34,117,327685,47,1885302377,1953067887,7237481,262149,59,1701080681,120,393221,
+74,1701470831,1667200099,1919904879,0,262149,78,1634497633,115,327685,103,1701080681,
+1818386808,101,196613,108,30325,262149,117,1768058209,7630437,327685,119,1667592307,
+1918987381,0,327685,120,1953654102,1867806821,6650181,393221,128,1751607628,1717916276,1952671084,
+0,393221,134,1667592275,1918987381,1952670022,29295,327685,151,1701080681,1818386808,101,
+327685,157,1734439526,1869377347,114,196679,24,14,262215,24,30,2,
+196679,172,14,262215,172,30,3,327752,32,0,35,80,
+327752,32,1,35,96,196679,32,2,262215,47,30,0,
+262215,78,34,0,262215,78,33,0,262215,108,30,1,
+262215,157,30,0,131091,2,196641,3,2,196630,6,32,
+262167,7,6,3,262176,8,7,7,262165,10,32,0,
+262187,10,11,6,262172,12,7,11,262187,6,13,1065353216,
+262187,6,14,0,393260,7,15,13,14,14,393260,7,
+16,14,13,14,393260,7,17,14,14,13,262187,6,
+18,3212836864,393260,7,19,18,14,14,393260,7,20,14,
+18,14,393260,7,21,14,14,18,589868,12,22,15,
+16,17,19,20,21,262176,23,1,10,262203,23,24,
+1,262203,23,172,1,262176,26,7,12,262176,30,7,
+6,262174,32,7,7,262176,33,9,32,262203,33,34,
+9,262165,35,32,1,262187,35,36,0,262176,37,9,
+7,262167,45,6,4,262176,46,1,45,262203,46,47,
+1,262187,6,51,1056964608,262176,58,7,10,262187,10,72,
+7,589849,75,6,1,0,0,0,1,0,196635,76,
+75,262176,77,0,76,262203,77,78,0,262187,6,82,
+1098907648,262187,6,84,1124073472,262167,86,6,2,262172,87,86,
+11,262187,6,88,1061158912,327724,86,89,88,14,262187,6,
+90,1051372203,327724,86,91,88,90,262187,6,92,1042983595,327724,
+86,93,88,92,327724,86,94,88,51,262187,6,95,
+1062557013,327724,86,96,88,95,262187,6,97,1059760811,327724,86,
+98,88,97,589868,87,99,89,91,93,94,96,98,
+262187,10,101,1,262176,102,7,87,262176,107,1,86,
+262203,107,108,1,262187,6,111,1040187392,327724,86,112,111,
+92,262187,6,118,1028443341,262187,35,121,1,131092,139,262187,
+6,144,1107296256,262187,10,174,8,262172,146,6,174,262187,
+6,147,1048576000,720940,146,148,13,14,51,147,14,13,
+14,51,262176,150,7,146,262176,156,3,45,262203,156,
+157,3,393260,7,163,14,13,13,327734,2,4,0,
+3,131320,5,262203,8,9,7,262203,26,27,7,262203,
+30,31,7,262203,58,59,7,262203,8,74,7,262203,
+102,103,7,262203,30,117,7,262203,30,119,7,262203,
+8,120,7,262203,8,128,7,262203,30,134,7,262203,
+150,151,7,262205,10,25,24,196670,27,22,327745,8,
+28,27,25,262205,7,29,28,196670,9,29,327745,37,
+38,34,36,262205,7,39,38,262271,7,40,39,262205,
+7,41,9,327828,6,42,40,41,458764,6,43,1,
+40,14,42,196670,31,43,262205,10,173,172,327879,10,
+73,173,72,196670,59,73,262205,76,79,78,262205,10,
+80,59,262256,6,81,80,327813,6,83,81,82,327816,
+6,85,83,84,262205,10,100,24,196670,103,99,393281,
+30,104,103,100,101,262205,6,105,104,327760,86,106,
+85,105,262205,86,109,108,393228,86,110,1,10,109,
+327813,86,113,110,112,327809,86,114,106,113,327767,45,
+115,79,114,524367,7,116,115,115,0,1,2,196670,
+74,116,196670,117,118,196670,119,14,327745,37,122,34,
+121,262205,7,123,122,262205,45,124,47,524367,7,125,
+124,124,0,1,2,327811,7,126,123,125,393228,7,
+127,1,69,126,196670,120,127,327745,37,129,34,36,
+262205,7,130,129,262205,7,131,9,458764,7,132,1,
+71,130,131,393228,7,133,1,69,132,196670,128,133,
+262205,7,135,120,262205,7,136,128,327828,6,137,135,
+136,196670,134,137,262205,6,138,134,327866,139,140,138,
+14,196855,142,0,262394,140,141,142,131320,141,262205,6,
+143,134,458764,6,145,1,26,143,144,196670,134,145,
+262205,10,149,59,196670,151,148,327745,30,152,151,149,
+262205,6,153,152,262205,6,154,134,327813,6,155,153,
+154,196670,119,155,131321,142,131320,142,262205,6,158,31,
+262205,6,159,117,327809,6,160,158,159,393296,7,161,
+160,160,160,262205,6,162,119,327822,7,164,163,162,
+327809,7,165,161,164,262205,7,166,74,327813,7,167,
+165,166,327761,6,168,167,0,327761,6,169,167,1,
+327761,6,170,167,2,458832,45,171,168,169,170,13,
+196670,157,171,65789,65592,
 };
@@ -5,6 +5,7 @@ layout (location = 1) in  vec3 v_texcoord;
 layout (location = 0) out vec4 out_position;
 layout (location = 1) out vec2 out_texcoord;
 layout (location = 2) out flat uint out_normal_index;
+layout (location = 3) out flat uint out_block_type;
 
 layout (push_constant) uniform A {
 	mat4 view_projection;
@@ -16,5 +17,8 @@ void main() {
 	gl_Position = transform.view_projection * vec4(position, 1.0);
 	out_position = vec4(position, gl_Position.z/100.0);
 	out_texcoord = v_texcoord.xy;
-	out_normal_index = uint(v_texcoord.z);
+	// normal index + 8 * block type, see Mesh_Data::add_chunk_quads
+	uint face = uint(v_texcoord.z);
+	out_normal_index = face & 7u;
+	out_block_type   = face >> 3;
 }
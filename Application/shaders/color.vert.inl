@@ -1,34 +1,53 @@
 /*
     Generated with file_to_cpp by Lazergenix
 */
-static constexpr unsigned int size = 2076;
+static constexpr unsigned int size = 2232;
 static constexpr unsigned int data[] = {
-119734787,65536,851979,69,0,131089,1,393227,1,1280527431,1685353262,808793134,
-0,196622,0,1,720911,0,4,1852399981,0,11,31,45,59,60,64,196611,2,450,655364,1197427783,1279741775,
-1885560645,1953718128,1600482425,1701734764,1919509599,1769235301,25974,
-524292,1197427783,1279741775,1852399429,1685417059,1768185701,1952671090,
-6649449,262149,4,1852399981,0,327685,9,1769172848,1852795252,0,327685,11,1869635446,
-1769236851,28271,196613,15,65,458758,15,0,2003134838,1869770847,1952671082,7237481,
-458758,15,1,1853188195,1869635435,1769236851,28271,327685,17,1851880052,1919903347,
+119734787,65536,851979,74,0,131089,1,393227,1,1280527431,1685353262,808793134,
+0,196622,0,1,786447,0,4,1852399981,0,11,31,45,
+59,60,64,69,196611,2,450,655364,1197427783,1279741775,1885560645,1953718128,
+1600482425,1701734764,1919509599,1769235301,25974,524292,1197427783,1279741775,1852399429,1685417059,1768185701,1952671090,
+6649449,262149,4,1852399981,0,327685,9,1769172848,1852795252,0,327685,11,
+1869635446,1769236851,28271,196613,15,65,458758,15,0,2003134838,1869770847,1952671082,
+7237481,458758,15,1,1853188195,1869635435,1769236851,28271,327685,17,1851880052,1919903347,
 109,393221,29,1348430951,1700164197,2019914866,0,393222,29,0,1348430951,1953067887,
 7237481,458758,29,1,1348430951,1953393007,1702521171,0,458758,29,2,1130327143,
-1148217708,1635021673,6644590,458758,29,3,1130327143,1147956341,1635021673,
-6644590,196613,31,0,393221,45,1601467759,1769172848,1852795252,0,393221,59,1601467759,
-1668834676,1685221231,0,327685,60,1702125430,1869570936,25714,458757,64,1601467759,
-1836216174,1767861345,2019910766,0,262215,11,30,0,262216,15,0,5,327752,15,0,35,0,327752,
-15,0,7,16,327752,15,1,35,64,196679,15,2,327752,29,0,11,0,327752,29,1,11,1,327752,29,2,11,3,327752,
-29,3,11,4,196679,29,2,262215,45,30,0,262215,59,30,1,262215,60,30,1,196679,64,14,262215,64,
-30,2,131091,2,196641,3,2,196630,6,32,262167,7,6,3,262176,8,7,7,262176,10,1,7,262203,10,11,
-1,262167,13,6,4,262168,14,13,4,262174,15,14,7,262176,16,9,15,262203,16,17,9,262165,18,32,
-1,262187,18,19,1,262176,20,9,7,262187,6,23,1090519040,262165,26,32,0,262187,26,27,1,262172,
-28,6,27,393246,29,13,6,28,28,262176,30,3,29,262203,30,31,3,262187,18,32,0,262176,33,9,14,262187,
-6,37,1065353216,262176,43,3,13,262203,43,45,3,262187,26,47,2,262176,48,3,6,262187,6,51,
-1120403456,262167,57,6,2,262176,58,3,57,262203,58,59,3,262203,10,60,1,262176,63,3,26,
-262203,63,64,3,262176,65,1,6,327734,2,4,0,3,131320,5,262203,8,9,7,262205,7,12,11,327745,20,
-21,17,19,262205,7,22,21,327822,7,24,22,23,327809,7,25,12,24,196670,9,25,327745,33,34,17,
-32,262205,14,35,34,262205,7,36,9,327761,6,38,36,0,327761,6,39,36,1,327761,6,40,36,2,458832,
-13,41,38,39,40,37,327825,13,42,35,41,327745,43,44,31,32,196670,44,42,262205,7,46,9,393281,
-48,49,31,32,47,262205,6,50,49,327816,6,52,50,51,327761,6,53,46,0,327761,6,54,46,1,327761,6,
-55,46,2,458832,13,56,53,54,55,52,196670,45,56,262205,7,61,60,458831,57,62,61,61,0,1,196670,
-59,62,327745,65,66,60,47,262205,6,67,66,262253,26,68,67,196670,64,68,65789,65592,
+1148217708,1635021673,6644590,458758,29,3,1130327143,1147956341,1635021673,6644590,196613,31,
+0,393221,45,1601467759,1769172848,1852795252,0,393221,59,1601467759,1668834676,1685221231,
+0,327685,60,1702125430,1869570936,25714,458757,64,1601467759,1836216174,1767861345,2019910766,
+0,393221,69,1601467759,1668246626,2037669739,25968,262215,11,30,0,262216,
+15,0,5,327752,15,0,35,0,327752,15,0,7,
+16,327752,15,1,35,64,196679,15,2,327752,29,0,
+11,0,327752,29,1,11,1,327752,29,2,11,3,
+327752,29,3,11,4,196679,29,2,262215,45,30,0,
+262215,59,30,1,262215,60,30,1,196679,64,14,262215,
+64,30,2,196679,69,14,262215,69,30,3,131091,2,
+196641,3,2,196630,6,32,262167,7,6,3,262176,8,
+7,7,262176,10,1,7,262203,10,11,1,262167,13,
+6,4,262168,14,13,4,262174,15,14,7,262176,16,
+9,15,262203,16,17,9,262165,18,32,1,262187,18,
+19,1,262176,20,9,7,262187,6,23,1090519040,262165,26,
+32,0,262187,26,27,1,262172,28,6,27,393246,29,
+13,6,28,28,262176,30,3,29,262203,30,31,3,
+262187,18,32,0,262176,33,9,14,262187,6,37,1065353216,
+262176,43,3,13,262203,43,45,3,262187,26,47,2,
+262176,48,3,6,262187,6,51,1120403456,262167,57,6,2,
+262176,58,3,57,262203,58,59,3,262203,10,60,1,
+262176,63,3,26,262187,26,70,7,262187,26,71,3,
+262203,63,64,3,262203,63,69,3,262176,65,1,6,
+327734,2,4,0,3,131320,5,262203,8,9,7,262205,
+7,12,11,327745,20,21,17,19,262205,7,22,21,
+327822,7,24,22,23,327809,7,25,12,24,196670,9,
+25,327745,33,34,17,32,262205,14,35,34,262205,7,
+36,9,327761,6,38,36,0,327761,6,39,36,1,
+327761,6,40,36,2,458832,13,41,38,39,40,37,
+327825,13,42,35,41,327745,43,44,31,32,196670,44,
+42,262205,7,46,9,393281,48,49,31,32,47,262205,
+6,50,49,327816,6,52,50,51,327761,6,53,46,
+0,327761,6,54,46,1,327761,6,55,46,2,458832,
+13,56,53,54,55,52,196670,45,56,262205,7,61,
+60,458831,57,62,61,61,0,1,196670,59,62,327745,
+65,66,60,47,262205,6,67,66,262253,26,68,67,
+327879,26,72,68,70,196670,64,72,327874,26,73,68,
+71,196670,69,73,65789,65592,
 };
@@ -124,9 +124,8 @@ auto Camera_Controller::update(float dt) -> void {
 	float speed = engine.modifier_keys & fs::keys::Mod_Control ? 50.0f : 5.0f;
 	auto [forward, left] = get_move_vectors();
 	auto up = glm::vec3(0.0f, 1.0f, 0.0f);
-	position += forward * move_speed.x * speed * dt;
-	position += left * move_speed.z * speed * dt;
-	position += up * move_speed.y * speed * dt;
+	velocity  = (forward * move_speed.x + left * move_speed.z + up * move_speed.y) * speed;
+	position += velocity * dt;
 
 	auto v = get_view_direction();
 	engine.debug_layer.add("view dir: %.1f,%.1f,%.1f", v.x, v.y, v.z);
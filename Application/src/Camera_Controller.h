@@ -12,6 +12,7 @@ struct Camera_Controller {
 	float      field_of_view = 1.0f;
 	fs::v2f32  view_rotation;
 	fs::v2f32  rotation_delta;
+	glm::vec3  velocity = glm::vec3(0.0f); // units per second, as moved by the last update
 
 	static constexpr float mouse_sensitivity = 0.004f;
 
@@ -0,0 +1,187 @@
+#include "block_types.h"
+#include <array>
+#include <cstring>
+
+namespace {
+	auto read_index(uint8_t const* indices, int bits, int i) -> int {
+		int bit = i * bits;
+		return (indices[bit >> 3] >> (bit & 7)) & ((1 << bits) - 1);
+	}
+	auto write_index(uint8_t* indices, int bits, int i, int index) -> void {
+		int bit = i * bits;
+		auto field = uint8_t(((1 << bits) - 1) << (bit & 7));
+		indices[bit >> 3] = uint8_t((indices[bit >> 3] & ~field) | (index << (bit & 7)));
+	}
+}
+
+auto Block_Section::allocate(int bits) -> void {
+	index_bits = uint8_t(bits);
+	storage = std::make_unique<uint8_t[]>(heap_bytes()); // zeroed, every voxel is palette entry 0
+}
+
+auto Block_Section::fill(Block_Type type) -> void {
+	storage.reset();
+	index_bits   = 0;
+	palette_size = 1;
+	uniform      = type;
+}
+
+auto Block_Section::decode(Block_Type out[voxel_count]) const -> void {
+	if (index_bits == 0) {
+		memset(out, uniform, voxel_count);
+		return;
+	}
+	uint8_t const* indices = storage.get() + palette_capacity();
+	for (int i = 0; i < voxel_count; ++i)
+		out[i] = storage[read_index(indices, index_bits, i)];
+}
+
+auto Block_Section::set(int i, Block_Type type) -> void {
+	if (index_bits == 0) {
+		if (type == uniform) return;
+		allocate(1);
+		storage[0] = uniform;
+	}
+
+	int index = 0;
+	while (index < palette_size && storage[index] != type) ++index;
+	if (index == palette_size) {
+		if (palette_size == palette_capacity()) {
+			// out of palette entries, twice as many bits per voxel
+			auto old = std::move(storage);
+			int old_bits = index_bits, old_capacity = 1 << old_bits;
+			allocate(old_bits * 2);
+			memcpy(storage.get(), old.get(), palette_size);
+			for (int v = 0; v < voxel_count; ++v)
+				write_index(storage.get() + palette_capacity(), index_bits, v, read_index(old.get() + old_capacity, old_bits, v));
+		}
+		storage[palette_size++] = type;
+	}
+	write_index(storage.get() + palette_capacity(), index_bits, i, index);
+}
+
+auto Block_Section::serialize(uint8_t out[serialized_bytes]) const -> void {
+	memset(out, 0, serialized_bytes);
+	out[0] = index_bits;
+	out[1] = uint8_t(palette_size);
+	out[2] = uniform;
+	if (index_bits) memcpy(out + 4, storage.get(), heap_bytes());
+}
+
+auto Block_Section::deserialize(uint8_t const in[serialized_bytes]) -> bool {
+	int bits = in[0], count = in[1];
+	if (bits != 0 && bits != 1 && bits != 2 && bits != 4) return false;
+	if (bits == 0) {
+		if (in[2] >= block_type_count) return false;
+		fill(in[2]);
+		return true;
+	}
+	if (count < 1 || count > (1 << bits)) return false;
+	for (int k = 0; k < count; ++k)
+		if (in[4 + k] >= block_type_count) return false;
+	uint8_t const* indices = in + 4 + (1 << bits);
+	for (int i = 0; i < voxel_count; ++i)
+		if (read_index(indices, bits, i) >= count) return false;
+
+	allocate(bits);
+	memcpy(storage.get(), in + 4, heap_bytes());
+	palette_size = uint16_t(count);
+	uniform      = in[2];
+	return true;
+}
+
+auto Block_Section::assign(Block_Type const* palette, int count, uint64_t const planes[][8]) -> void {
+	if (count <= 1) {
+		fill(count ? palette[0] : Block_Type(block_stone));
+		return;
+	}
+	allocate(count <= 2 ? 1 : count <= 4 ? 2 : count <= 16 ? 4 : 8);
+	memcpy(storage.get(), palette, count);
+	palette_size = uint16_t(count);
+
+	// spread[b][x] moves bit k of x to bit k*b, the indices of 8 voxels of one plane
+	static auto const spread = [] {
+		std::array<std::array<uint64_t, 256>, 9> table = {};
+		for (int b : { 1, 2, 4, 8 })
+		for (int x = 0; x < 256; ++x)
+		for (int k = 0; k < 8; ++k)
+			table[b][x] |= uint64_t((x >> k) & 1) << (k * b);
+		return table;
+	}();
+
+	uint8_t* indices = storage.get() + palette_capacity();
+	for (int layer = 0; layer < 8; ++layer)
+	for (int row = 0; row < 8; ++row) {
+		// 8 voxels, index_bits bytes of output
+		uint64_t packed = 0;
+		for (int p = 0; p < index_bits; ++p)
+			packed |= spread[index_bits][(planes[p][layer] >> (row * 8)) & 0xFF] << p;
+		memcpy(indices + (layer * 64 + row * 8) * index_bits / 8, &packed, index_bits);
+	}
+}
+
+auto assign_block_types(Terrain_Column const& column, Block_Section* sections, uint8_t const* mask_above) -> void {
+	constexpr int sand_line = 20; // surfaces below this are sand
+	constexpr int snow_line = 96; // and at or above this snow
+
+	auto layer = [&](int y) -> uint64_t {
+		uint64_t bits;
+		memcpy(&bits, column.masks + (y / 8) * 64 + (y % 8) * 8, sizeof(bits));
+		return bits;
+	};
+
+	// walks down layer by layer, each bit is one (x, z): above[k] is the layer k+1 voxels up,
+	// so the depth below the nearest air tells surface, dirt and stone apart with a few bit ops
+	uint64_t above[4] = {};
+	if (mask_above)
+		for (int k = 0; k < 4; ++k) memcpy(&above[k], mask_above + k * 8, sizeof(uint64_t));
+	for (int cy = column.section_count - 1; cy >= 0; --cy) {
+		auto& section = sections[cy];
+		if (cy * 8 >= column.max_height) {
+			section.fill(block_stone); // empty, and `above` is all air from here on
+			above[0] = above[1] = above[2] = above[3] = 0;
+			continue;
+		}
+
+		uint64_t solid[8], surface[8], dirt[8], mixed = 0;
+		for (int ly = 7; ly >= 0; --ly) {
+			solid[ly]   = layer(cy * 8 + ly);
+			surface[ly] = solid[ly] & ~above[0];
+			dirt[ly]    = solid[ly] & above[0] & ~(above[1] & above[2] & above[3]);
+			mixed |= surface[ly] | dirt[ly];
+			above[3] = above[2]; above[2] = above[1]; above[1] = above[0]; above[0] = solid[ly];
+		}
+		if (!mixed) {
+			section.fill(block_stone); // buried, or empty
+			continue;
+		}
+
+		// palette in order of first use, then one bit plane per index bit
+		Block_Type palette[block_type_count];
+		int count = 0;
+		auto index_of = [&](Block_Type type) -> int {
+			for (int k = 0; k < count; ++k) if (palette[k] == type) return k;
+			palette[count] = type;
+			return count++;
+		};
+		int layer_index[8][3]; // stone, dirt, surface
+		for (int ly = 0; ly < 8; ++ly) {
+			int y = (column.section_y + cy) * 8 + ly;
+			Block_Type top = (y < sand_line) ? block_sand : (y >= snow_line) ? block_snow : block_grass;
+			uint64_t stone = solid[ly] & ~surface[ly] & ~dirt[ly];
+			layer_index[ly][0] = stone       ? index_of(block_stone) : 0;
+			layer_index[ly][1] = dirt[ly]    ? index_of(block_dirt)  : 0;
+			layer_index[ly][2] = surface[ly] ? index_of(top)         : 0;
+		}
+		uint64_t planes[4][8] = {}; // up to 16 types, a section has at most 4
+		for (int ly = 0; ly < 8; ++ly) {
+			uint64_t stone = solid[ly] & ~surface[ly] & ~dirt[ly];
+			for (int p = 0; p < 4; ++p) {
+				if ((layer_index[ly][0] >> p) & 1) planes[p][ly] |= stone;
+				if ((layer_index[ly][1] >> p) & 1) planes[p][ly] |= dirt[ly];
+				if ((layer_index[ly][2] >> p) & 1) planes[p][ly] |= surface[ly];
+			}
+		}
+		section.assign(palette, count, planes);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "terrain.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Block ids, one per column of the block atlas.
+using Block_Type = uint8_t;
+enum : Block_Type {
+	block_stone,
+	block_dirt,
+	block_grass,
+	block_sand,
+	block_snow,
+	block_gravel,
+	block_clay,
+	block_placed, // whatever the player builds with
+
+	block_type_count
+};
+static_assert(block_type_count <= 16); // see Block_Section::serialized_bytes
+
+// Block types of one 8x8x8 section, voxel i = y*64 + z*8 + x (the same order as the section's bitmask).
+//
+// Every voxel holds an index into a small palette, packed 1, 2, 4 or 8 bits wide, and the width only
+// grows when the palette runs out of room. A section with a single type keeps it inline and has no
+// heap storage, so homogeneous sections cost sizeof(Block_Section) on top of their 64 byte mask.
+// Only solid voxels have a meaningful type, the bitmask stays the authority on what is solid.
+struct Block_Section {
+	static constexpr int voxel_count = 8*8*8;
+
+	auto get(int i) const -> Block_Type {
+		if (index_bits == 0) return uniform;
+		int bit = i * index_bits;
+		int index = (storage[palette_capacity() + (bit >> 3)] >> (bit & 7)) & ((1 << index_bits) - 1);
+		return storage[index];
+	}
+	auto set(int i, Block_Type type) -> void;
+
+	// All 512 types, in voxel order.
+	auto decode(Block_Type out[voxel_count]) const -> void;
+
+	// Every voxel becomes `type`, frees the storage.
+	auto fill(Block_Type type) -> void;
+
+	// Builds the whole section at once from `count` palette entries and the voxels' palette indices
+	// as bit planes: bit p of voxel (x, y, z)'s index is bit z*8+x of planes[p][y]. Needs one plane
+	// per bit of the smallest width that holds `count` (1, 2, 4 or 8).
+	auto assign(Block_Type const* palette, int count, uint64_t const planes[][8]) -> void;
+
+	// Fixed size form for storing, the header fields then the storage. There are few enough block
+	// types that the indices never grow past 4 bits.
+	static constexpr size_t serialized_bytes = 4 + 16 + voxel_count * 4 / 8;
+	auto serialize(uint8_t out[serialized_bytes]) const -> void;
+	// False, and the section left as it was, when `in` is not something serialize wrote.
+	auto deserialize(uint8_t const in[serialized_bytes]) -> bool;
+
+	auto palette_capacity() const -> int { return index_bits ? 1 << index_bits : 0; }
+	auto heap_bytes() const -> size_t { return index_bits ? size_t(palette_capacity()) + voxel_count * index_bits / 8 : 0; }
+
+	uint8_t    index_bits   = 0; // 0 while the whole section is `uniform`
+	uint16_t   palette_size = 1;
+	Block_Type uniform      = block_stone;
+
+private:
+	auto allocate(int bits) -> void;
+
+	// palette_capacity() palette entries followed by the packed indices, null while index_bits is 0
+	std::unique_ptr<uint8_t[]> storage;
+};
+
+// Types for a freshly generated or loaded column, derived from its shape: the top voxel of every
+// run of solid voxels is the surface (grass, sand down low, snow up high), the next few are dirt
+// and everything deeper is stone. `sections` has one entry per section of `column`.
+// `mask_above` is the bitmask of the section right above the column's top one, null when that is air.
+auto assign_block_types(Terrain_Column const& column, Block_Section* sections, uint8_t const* mask_above = nullptr) -> void;
@@ -0,0 +1,160 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Cave culling: which sections can be seen from the camera's section at all, going only through air.
+//
+// Every 8x8x8 section gets its face connectivity when it is meshed: for each pair of its six faces,
+// whether some pocket of air touches both. A breadth-first search from the camera's section then
+// only steps from a section into a neighbor through a face its entry face connects to, and never
+// back along an axis it already moved on, the way a ray crosses sections. Underground or in a valley
+// the search stays in the caves and open air around the camera, sections of solid rock it never
+// reaches are not drawn. Sections outside the view are not entered either, which keeps the search
+// small in the open, where everything around the camera is reachable.
+//
+// Faces and search directions are 0 -x, 1 +x, 2 -y, 3 +y, 4 -z, 5 +z; the opposite of f is f ^ 1.
+
+// 15 bits, one per unordered pair of faces.
+using Face_Connectivity = uint16_t;
+constexpr Face_Connectivity all_faces_connected = 0x7FFF;
+
+constexpr auto face_pair_bit(int a, int b) -> Face_Connectivity {
+	if (a > b) { int t = a; a = b; b = t; }
+	return Face_Connectivity(1u << (a * 5 - a * (a - 1) / 2 + (b - a - 1)));
+}
+
+constexpr auto faces_connected(Face_Connectivity connectivity, int a, int b) -> bool {
+	return a != b && (connectivity & face_pair_bit(a, b));
+}
+
+// Connectivity of the section with bitmask `mask` (64 bytes, row y*8+z holds bits for x).
+// Flood fills each pocket of air a layer of 64 voxels at a time.
+inline auto face_connectivity(uint8_t const mask[64]) -> Face_Connectivity {
+	constexpr uint64_t x0 = 0x0101010101010101ull, x7 = x0 << 7;
+	constexpr uint64_t z0 = 0xFFull, z7 = z0 << 56;
+
+	uint64_t air[8], left = 0;
+	for (int y = 0; y < 8; ++y) {
+		memcpy(&air[y], mask + y * 8, 8);
+		air[y] = ~air[y];
+		left |= air[y];
+	}
+	if (!left) return 0;
+	bool all_air = true;
+	for (int y = 0; y < 8; ++y) all_air &= air[y] == ~uint64_t(0);
+	if (all_air) return all_faces_connected;
+
+	uint64_t unvisited[8];
+	memcpy(unvisited, air, sizeof(air));
+	Face_Connectivity result = 0;
+	for (int seed = 0; seed < 8; ) {
+		if (!unvisited[seed]) { ++seed; continue; }
+
+		uint64_t pocket[8] = {};
+		pocket[seed] = unvisited[seed] & (~unvisited[seed] + 1); // its lowest voxel
+		for (bool grew = true; grew; ) {
+			grew = false;
+			for (int y = 0; y < 8; ++y) {
+				uint64_t p = pocket[y];
+				uint64_t g = p | ((p << 1) & ~x0) | ((p >> 1) & ~x7) | (p << 8) | (p >> 8);
+				if (y > 0) g |= pocket[y - 1];
+				if (y < 7) g |= pocket[y + 1];
+				g &= air[y];
+				if (g != p) { pocket[y] = g; grew = true; }
+			}
+		}
+
+		uint64_t any = 0;
+		for (int y = 0; y < 8; ++y) {
+			unvisited[y] &= ~pocket[y];
+			any |= pocket[y];
+		}
+		int faces = ((any & x0) != 0) | ((any & x7) != 0) << 1 | (pocket[0] != 0) << 2 | (pocket[7] != 0) << 3
+			| ((any & z0) != 0) << 4 | ((any & z7) != 0) << 5;
+		for (int a = 0; a < 6; ++a)
+		for (int b = a + 1; b < 6; ++b)
+			if (((faces >> a) & 1) && ((faces >> b) & 1)) result |= face_pair_bit(a, b);
+		if (result == all_faces_connected) break;
+	}
+	return result;
+}
+
+// The planes of a view_projection with depth from 0 to 1, for testing boxes against the view.
+struct View_Frustum {
+	glm::vec4 planes[6]; // inside where dot(xyz, point) + w >= 0
+
+	View_Frustum(glm::mat4 const& m) {
+		auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+		planes[0] = row(3) + row(0);
+		planes[1] = row(3) - row(0);
+		planes[2] = row(3) + row(1);
+		planes[3] = row(3) - row(1);
+		planes[4] = row(2);
+		planes[5] = row(3) - row(2);
+	}
+
+	// False when the box [lo, hi] is entirely outside.
+	auto overlaps(glm::vec3 lo, glm::vec3 hi) const -> bool {
+		for (auto const& p : planes) {
+			// the corner furthest along the plane's normal
+			float x = (p.x >= 0.0f) ? hi.x : lo.x;
+			float y = (p.y >= 0.0f) ? hi.y : lo.y;
+			float z = (p.z >= 0.0f) ? hi.z : lo.z;
+			if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) return false;
+		}
+		return true;
+	}
+};
+
+// The search, its buffers are kept between frames.
+struct Cave_Culling {
+	// Sections reachable from `start`, within the box [lo, hi). `connectivity(x, y, z)` returns the
+	// Face_Connectivity of a section, or -1 when it cannot be entered at all. `visit(x, y, z)` is
+	// called once for each section reached, `start` included. Returns the number of sections visited.
+	template <typename Connectivity, typename Visit>
+	auto search(glm::ivec3 start, glm::ivec3 lo, glm::ivec3 hi, Connectivity&& connectivity, Visit&& visit) -> int {
+		int size_x = hi.x - lo.x, size_y = hi.y - lo.y, size_z = hi.z - lo.z;
+		visited.assign(size_t(size_x) * size_y * size_z, 0);
+		queue.clear();
+
+		int const stride[6] = { -1, 1, -size_x * size_z, size_x * size_z, -size_x, size_x };
+		auto index = [&](int x, int y, int z) { return ((y - lo.y) * size_z + (z - lo.z)) * size_x + (x - lo.x); };
+		visited[index(start.x, start.y, start.z)] = 1;
+		visit(start.x, start.y, start.z);
+		// the camera's own section can be looked out of on all sides, even from inside rock
+		queue.push_back({ int16_t(start.x), int16_t(start.y), int16_t(start.z), 0, 0, all_faces_connected });
+
+		for (size_t head = 0; head < queue.size(); ++head) {
+			Node node = queue[head];
+			int at = index(node.x, node.y, node.z);
+			for (int d = 0; d < 6; ++d) {
+				if ((node.directions >> (d ^ 1)) & 1) continue; // would turn back
+				if (head && !faces_connected(node.open, node.entry, d)) continue;
+				int x = node.x + (d == 1) - (d == 0);
+				int y = node.y + (d == 3) - (d == 2);
+				int z = node.z + (d == 5) - (d == 4);
+				if (x < lo.x || y < lo.y || z < lo.z || x >= hi.x || y >= hi.y || z >= hi.z) continue;
+				auto& seen = visited[size_t(at + stride[d])];
+				if (seen) continue;
+				seen = 1;
+				int open = connectivity(x, y, z);
+				if (open < 0) continue;
+				visit(x, y, z);
+				queue.push_back({ int16_t(x), int16_t(y), int16_t(z), uint8_t(d ^ 1), uint8_t(node.directions | (1 << d)), Face_Connectivity(open) });
+			}
+		}
+		return int(queue.size());
+	}
+
+private:
+	struct Node {
+		int16_t  x, y, z;
+		uint8_t  entry;      // face it was entered through, unused for the start
+		uint8_t  directions; // bit per direction moved in on the way here
+		Face_Connectivity open;
+	};
+	std::vector<uint8_t> visited;
+	std::vector<Node>    queue;
+};
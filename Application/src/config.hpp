@@ -7,11 +7,62 @@
 #define SQ(X) (X*X)
 #define MAP2D(X,Y,WIDTH) (Y * WIDTH + X)
 
+// sections kept loaded per column, a window centered on the camera; the world itself has no height limit
 static constexpr int world_chunk_height = 16;
 
 inline int64_t total_vertex_gpu_memory = 0;
 inline int64_t used_vertex_gpu_memory  = 0;
 inline int64_t total_number_of_quads   = 0;
 
-inline int render_chunk_radius = RAIN?12:64;
+// past 4*lod_distance every mesh is 8x coarser, and its vertex buffer sized to match
+inline int render_chunk_radius = RAIN?12:128;
+
+// chunks past the render radius that stay loaded and meshed, so turning back regenerates nothing;
+// narrower when the extra columns and vertex buffers would not fit in the cap
+inline int retention_chunks = 2;
+inline int retention_memory_cap_mib = 256;
+// sections the camera can move up or down before the vertical window follows
+inline int vertical_hysteresis = 1;
+// seconds of travel the window is centered ahead of a moving camera, when the workers are idle;
+// the lead is limited to the retention margin (and vertical_hysteresis up and down)
+inline float prefetch_seconds = 0.5f;
+
+// skip columns hidden behind the terrain in front of them (H toggles), the horizon around the camera
+// is kept in this many azimuth bins
+inline bool use_horizon_culling = true;
+inline int horizon_bins = 2048;
+// skip sections the camera cannot see into through air, underground or in valleys (V toggles);
+// only searched this many chunks out, further away the horizon does the culling
+inline bool use_cave_culling = true;
+inline int cave_culling_radius = 16;
+
+// chunks from the camera where meshes start to be built from downsampled voxels:
+// 2x coarser from here, 4x from twice as far and 8x from four times; 0 keeps full resolution
+inline int lod_distance = 16;
+
+// world type (see terrain_generator_names) and seed, overridden at startup by terrain.txt ("<name> <seed>")
+inline const char* terrain_generator = "mountains";
+inline int terrain_seed = 0;
+
+// keep generated columns in region files under `region_directory`, revisited areas load instead of regenerating
+inline bool use_region_store = true;
+inline const char* region_directory = "world";
+
+// meshed chunks remembered by content, identical ones reuse the quads instead of meshing again
+// (each entry keeps the 560 bytes it is compared by on top of its quads)
+inline int quad_cache_max_entries = 1 << 16;
+// and on disk in `region_directory`, so restarts and revisited areas skip meshing too
+inline bool use_mesh_store = true;
+inline int mesh_store_max_mib = 256;
+
+// voxels between 3D noise samples for volumetric terrain (1, 2, 4 or 8)
+inline int density_lattice_step = 4;
+
+// share the low frequency octaves of the heightfield noise between columns; the octaves are upsampled
+// bilinearly, so the surface is off by one voxel in ~11% of places on the mountains (never more).
+// Off by default, the exact noise is the reference
+inline bool use_noise_cache = false;
+// samples per lattice cell for cached octaves, 32 is ~4x more accurate but caches one octave less
+inline int  noise_cache_samples_per_cell = 16;
+inline int  noise_cache_max_tiles = 4096;
 #endif
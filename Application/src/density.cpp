@@ -0,0 +1,63 @@
+#include "density.h"
+#include "noise.h"
+#include <vector>
+
+auto fill_density_column(int x0, int y0, int z0, Density_Params const& params, uint8_t* masks, int section_count) -> void {
+	int step = params.lattice_step;
+	if (step != 1 && step != 2 && step != 4 && step != 8) step = 4;
+
+	int height = section_count * 8;
+	int nx = 8 / step + 1;
+	int nz = 8 / step + 1;
+	int ny = height / step + 1;
+	int plane_size = nx * nz;
+
+	// reused between calls, generation runs on more than one thread
+	thread_local std::vector<float> px, py, pz, lattice, plane;
+	int count = plane_size * ny;
+	px.resize(count); py.resize(count); pz.resize(count); lattice.resize(count);
+	plane.resize(plane_size);
+
+	// 1. sample noise on the lattice, one batch for the whole column
+	int n = 0;
+	for (int ly = 0; ly < ny; ++ly)
+	for (int lz = 0; lz < nz; ++lz)
+	for (int lx = 0; lx < nx; ++lx) {
+		px[n] = float(x0 + lx * step) * params.scale;
+		py[n] = float(y0 + ly * step) * params.scale;
+		pz[n] = float(z0 + lz * step) * params.scale;
+		++n;
+	}
+	noise::noise3(px.data(), py.data(), pz.data(), count, lattice.data());
+
+	// 2. interpolate: lerp two lattice planes along y once per voxel layer, then bilinear in x,z
+	float inv_step = 1.0f / float(step);
+	for (int y = 0; y < height; ++y) {
+		int   ly = y / step;
+		float ty = float(y % step) * inv_step;
+		float const* below = lattice.data() + ly * plane_size;
+		float const* above = (ty > 0.0f) ? below + plane_size : below;
+		for (int i = 0; i < plane_size; ++i)
+			plane[i] = below[i] + (above[i] - below[i]) * ty;
+
+		uint8_t* rows = masks + (y / 8) * 64 + (y % 8) * 8;
+		for (int z = 0; z < 8; ++z) {
+			int   lz = z / step;
+			float tz = float(z % step) * inv_step;
+			float const* near_row = plane.data() + lz * nx;
+			float const* far_row  = (tz > 0.0f) ? near_row + nx : near_row;
+
+			uint8_t bits = 0;
+			for (int x = 0; x < 8; ++x) {
+				int   lx = x / step;
+				float tx = float(x % step) * inv_step;
+				int   lx1 = (tx > 0.0f) ? lx + 1 : lx;
+				float d0 = near_row[lx] + (near_row[lx1] - near_row[lx]) * tx;
+				float d1 = far_row [lx] + (far_row [lx1] - far_row [lx]) * tx;
+				float density = d0 + (d1 - d0) * tz;
+				bits |= uint8_t(density > params.threshold) << x;
+			}
+			rows[z] |= bits;
+		}
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// Volumetric terrain from 3D noise.
+// Noise is only evaluated on a coarse lattice every `lattice_step` voxels, lattice points
+// are aligned to world coordinates so neighboring columns agree on their shared faces,
+// and every voxel gets its density by trilinear interpolation of the 8 surrounding samples.
+struct Density_Params {
+	float scale        = 1.0f / 64.0f; // noise frequency per voxel
+	float threshold    = 0.1f;         // voxels with density above this are solid
+	int   lattice_step = 4;            // voxels between noise samples: 1, 2, 4 or 8 (1 = sample every voxel)
+};
+
+// Fills `section_count` stacked 8x8x8 bitmasks (64 bytes each, row y*8+z holds bits for x)
+// for the column whose lowest voxel is at world location (x0, y0, z0). Masks are OR'ed into.
+// `y0` has to be a multiple of 8 so the lattice stays aligned.
+auto fill_density_column(int x0, int y0, int z0, Density_Params const& params, uint8_t* masks, int section_count) -> void;
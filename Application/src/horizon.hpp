@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Occlusion culling against the terrain's horizon, on the CPU.
+//
+// All around the eye the horizon is kept per azimuth bin as the steepest slope (rise over
+// horizontal distance) that terrain seen so far blocks: every ray in the bin at or below it hits
+// something solid. Columns are fed front to back, a column whose highest geometry only reaches
+// below the horizon in every bin it covers cannot be seen, and its solid part raises the horizon
+// for the columns behind it.
+//
+// Coordinates are relative to the eye, x and z horizontal. Boxes are column footprints with the
+// eye outside of them. Bins are spaced in "diamond angle" (a monotonic stand-in for atan2 in
+// [0, 4)), so only bins fully behind a footprint are raised and a test covers every bin it
+// touches: culling is conservative.
+struct Horizon {
+	struct Span {
+		int   first = 0, last = -1; // bins the footprint touches, `last` may pass `bins` and wraps
+		float lo = 0.0f, hi = 0.0f; // in bins, unwrapped
+		float near = 0.0f, far = 0.0f; // horizontal distance to the closest and farthest point of the footprint
+	};
+
+	int const bins;
+	std::vector<float> slopes;
+
+	Horizon(int bins = 2048) : bins(bins), slopes(size_t(bins)) { clear(); }
+
+	auto clear() -> void {
+		std::fill(slopes.begin(), slopes.end(), -std::numeric_limits<float>::infinity());
+	}
+
+	// Azimuth range and distances of footprint [x0, x1] by [z0, z1], false when the eye is in it.
+	auto span(float x0, float z0, float x1, float z1, Span& s) const -> bool {
+		float dx = std::max({ x0, -x1, 0.0f });
+		float dz = std::max({ z0, -z1, 0.0f });
+		s.near = std::sqrt(dx*dx + dz*dz);
+		if (s.near < 1e-3f) return false;
+		s.far = std::sqrt(std::max(x0*x0, x1*x1) + std::max(z0*z0, z1*z1));
+
+		// corners around the center's direction, a footprint the eye is outside of spans less than half a turn
+		float center = diamond_angle(x0 + x1, z0 + z1);
+		float lo = 0.0f, hi = 0.0f;
+		for (float x : { x0, x1 })
+		for (float z : { z0, z1 }) {
+			float d = diamond_angle(x, z) - center;
+			if (d >= 2.0f) d -= 4.0f;
+			if (d < -2.0f) d += 4.0f;
+			lo = std::min(lo, d);
+			hi = std::max(hi, d);
+		}
+		float scale = float(bins) / 4.0f;
+		s.lo = (center + lo) * scale;
+		s.hi = (center + hi) * scale;
+		s.first = int(std::floor(s.lo));
+		s.last  = int(std::floor(s.hi));
+		return true;
+	}
+
+	// False when everything up to height `top` above the eye over the footprint is below the horizon.
+	auto visible(Span const& s, float top) const -> bool {
+		float slope = top / (top >= 0.0f ? s.near : s.far); // steepest point of the box
+		for (int b = s.first; b <= s.last; ++b)
+			if (slopes[wrap(b)] < slope) return true;
+		return false;
+	}
+
+	// Raises the horizon behind a footprint that is solid up to `height` above the eye.
+	auto occlude(Span const& s, float height) -> void {
+		float slope = height / (height >= 0.0f ? s.far : s.near); // flattest point of the box's top
+		for (int b = int(std::ceil(s.lo)); b + 1 <= int(std::floor(s.hi)); ++b) {
+			float& h = slopes[wrap(b)];
+			h = std::max(h, slope);
+		}
+	}
+
+private:
+	auto wrap(int b) const -> int { return ((b % bins) + bins) % bins; }
+
+	// Monotonic in the angle of (x, z), 0 along +x, 1 along +z, 2 along -x, 3 along -z.
+	static auto diamond_angle(float x, float z) -> float {
+		if (z >= 0.0f) return (x >= 0.0f) ? z / (x + z) : 1.0f - x / (z - x);
+		else           return (x <  0.0f) ? 2.0f - z / (-x - z) : 3.0f + x / (x - z);
+	}
+};
@@ -6,14 +6,24 @@
 #include <format>
 #include <execution>
 #include <fstream>
+#include <deque>
 #include "Camera_Controller.h"
 #include "Skybox.h"
 #include "outline_technique.h"
 #define STB_IMAGE_IMPLEMENTATION 1
 #include <stb_image.h>
-#define STB_PERLIN_IMPLEMENTATION 1
-#include <stb_perlin.h>
+#include "noise.h"
+#include "noise_cache.h"
+#include "terrain.h"
+#include "region_store.h"
+#include "block_types.h"
 #include "mesher.hpp"
+#include "quad_cache.hpp"
+#include "mesh_store.h"
+#include "raycast.hpp"
+#include "horizon.hpp"
+#include "cave_culling.hpp"
+#include "mpsc_ring.hpp"
 #include "config.hpp"
 
 extern void display_fatal_error(const char* title, const char* what);
@@ -24,53 +34,146 @@ struct vertex {
 	fs::v3f32 texcoord;
 };
 
-#define TERRAIN_BLOBS     0
-#define TERRAIN_MOUNTAINS 1
-#define TERRAIN 1
-auto terrain_height_from_location(int x, int z) -> float {
-	return 1.0f * stb_perlin_ridge_noise3(float(x) / 256.0f, float(z) / 256.0f, 0.225f, 2.0f, 0.5f, 1.0f, 6); // mountains
-//	return 2.0f * stb_perlin_ridge_noise3(float(x) / 64.0f, float(z) / 64.0f, 0.225f, 2.0f, 0.5f, 1.0f, 6); // spiky mountains
-//	return 1.0f + 0.7f * stb_perlin_fbm_noise3(float(x) / 256.0f, float(z) / 256.0f, 0.435f, 2.0f, 0.5f, 8); // bumpy
-//	return 0.5f + 0.2f * stb_perlin_fbm_noise3(float(x) / 64.0f, float(z) / 64.0f, 0.435f, 2.0f, 0.3f, 8); // flat
-}
-
 inline bool ran_out_of_memory = false;
 
 int chunk_generation_thread_main(struct Chunk_Generation_Thread_Info* info);
+int column_io_thread_main(struct Column_IO_Thread_Info* info);
+
+// CPU side result of meshing a column, filled in by the meshing thread
+// and copied into the column's vertex buffer by the render thread.
+struct Mesh_Data {
+	std::vector<vertex> vertices;
+	int number_of_quads = 0;
+
+	int section = -1; // -1 for the whole column, otherwise the ring slot of the one section in `vertices`
+	int section_quads[world_chunk_height] = {}; // whole column only, quads per ring slot in slot order
+	int open_section = -1; // whole column only, slot of the section above the highest one with faces
+
+	// world voxel layers, of the whole column either way: solid from the window's bottom up to
+	// `solid_top`, nothing at or above `top`
+	int solid_top = 0;
+	int top = 0;
+
+	Face_Connectivity section_connectivity[world_chunk_height] = {}; // of the sections meshed, per ring slot
+
+	auto clear() -> void {
+		vertices.clear();
+		number_of_quads = 0;
+		section = -1;
+		memset(section_quads, 0, sizeof(section_quads));
+		open_section = -1;
+		solid_top = top = 0;
+	}
+
+	auto add_chunk_quads (std::vector<quad> const& quads, int oy) -> void {
+		for (auto const& q : quads) {
+			auto na = q.normal_axis;
+
+			if (na < 0) {
+				na += 3;
+			}
+
+			union vec3 {
+				char comp[4];
+				struct {
+					char x, y, z, _;
+				};
+			};
+			vec3 p00, p01, p10, p11;
+			int i_axis = (na + 1) % 3;
+			int j_axis = (na + 2) % 3;
+
+			p00.comp[na] = q.slice;
+			p00.comp[i_axis] = q.i0;
+			p00.comp[j_axis] = q.j0;
+
+			p01.comp[na] = q.slice;
+			p01.comp[i_axis] = q.i0;
+			p01.comp[j_axis] = q.j1;
+
+			p10.comp[na] = q.slice;
+			p10.comp[i_axis] = q.i1;
+			p10.comp[j_axis] = q.j0;
+
+			p11.comp[na] = q.slice;
+			p11.comp[i_axis] = q.i1;
+			p11.comp[j_axis] = q.j1;
+
+			// the normal index (0-5) and the block type share the last texcoord, normal + 8*type
+			float normal = 0.5f + float(q.normal_axis + 3) + 8.0f * float(q.type);
+			float u1 = float(q.i1 - q.i0), v1 = float(q.j1 - q.j0);
+			if (q.normal_axis >= 0) {
+				vertices.push_back({ fs::v3f32(float(p00.x), float(p00.y + oy), float(p00.z)), {0.0f, 0.0f, normal} });
+				vertices.push_back({ fs::v3f32(float(p01.x), float(p01.y + oy), float(p01.z)), {0.0f, v1  , normal} });
+				vertices.push_back({ fs::v3f32(float(p11.x), float(p11.y + oy), float(p11.z)), {u1  , v1  , normal} });
+				vertices.push_back({ fs::v3f32(float(p10.x), float(p10.y + oy), float(p10.z)), {u1  , 0.0f, normal} });
+			} else {
+				vertices.push_back({ fs::v3f32(float(p01.x), float(p01.y + oy), float(p01.z)), {0.0f, v1  , normal} });
+				vertices.push_back({ fs::v3f32(float(p00.x), float(p00.y + oy), float(p00.z)), {0.0f, 0.0f, normal} });
+				vertices.push_back({ fs::v3f32(float(p10.x), float(p10.y + oy), float(p10.z)), {u1  , 0.0f, normal} });
+				vertices.push_back({ fs::v3f32(float(p11.x), float(p11.y + oy), float(p11.z)), {u1  , v1  , normal} });
+			}
+		}
+		number_of_quads += (int)quads.size();
+	};
+};
 
 struct Chunk_Mesh {
-	VmaAllocation vertex_allocation;
-	VkBuffer      vertex_buffer;
+	VmaAllocation vertex_allocation = nullptr;
+	VkBuffer      vertex_buffer     = nullptr;
+	fs::u32       vertex_capacity   = 0; // sized to the mesh, a power of two up to max_vertex_count
 
 	static VmaAllocation index_allocation;
 	static VkBuffer      index_buffer;
 	
 	int index_count;
 
+	// Only touched by the render thread.
 	bool ready_to_render = false;
 
+	// Bumped every time new work is queued for this mesh; results carrying an older ticket are stale.
+	fs::u32 ticket = 0;
+
+	// Vertex buffer layout, in quads: the section in ring slot s owns [section_first[s], section_first[s+1]).
+	// Its quads come first and the rest of the range is zeroed (degenerate) padding, so a single
+	// section can be rewritten in place while the column still draws with one call.
+	fs::u16 section_first[world_chunk_height + 1] = {};
+	fs::u16 section_quads[world_chunk_height] = {};
+	fs::u32 section_tickets[world_chunk_height] = {}; // same as `ticket`, for single section work
+	bool    full_rebuild_pending = false; // section results would be overwritten, remesh it whole
+
+	// bumped by every edit, jobs carry the value they were queued with
+	fs::u32 edit_serial = 0;
+
 	int number_of_quads = 0;
 	int bytes_used = 0;
 
+	int solid_top = 0, top = 0; // see Mesh_Data, for horizon culling
+	int    lod = 0;    // of the last full rebuild queued, see Mesh_Columns
+	fs::u8 skirts = 0;
+	Face_Connectivity section_connectivity[world_chunk_height] = {}; // per ring slot, for cave culling
+
 	static constexpr fs::u32 max_vertex_count = 1 << 11;
+	static constexpr fs::u32 min_vertex_count = 1 << 6;
+	static constexpr int     section_slack    = 4; // spare quads per section, when they fit
+
+	// A vertex buffer the mesh stopped using, destroyed once no frame in flight can still draw from it.
+	struct Retired_Buffer {
+		VkBuffer      buffer;
+		VmaAllocation allocation;
+		int64_t       frame;
+	};
+	static constexpr int64_t retire_frames = 4; // more than the engine keeps in flight
+	static inline std::vector<Retired_Buffer> retired_buffers;
+	static inline int64_t frame = 0;
 
 	auto create(fs::Graphics& gfx) -> void {
-		VmaAllocationCreateInfo ai = {};
-		ai.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
-		ai.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-		VkBufferCreateInfo bi = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-
-		bi.size = max_vertex_count * sizeof(vertex);
-		bi.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-		auto vkr = vmaCreateBuffer(gfx.allocator, &bi, &ai, &vertex_buffer, &vertex_allocation, nullptr);
-		if (vkr) {
-			VmaTotalStatistics stats;
-			vmaCalculateStatistics(gfx.allocator, &stats);
-			__debugbreak();
-		}
-		total_vertex_gpu_memory += bi.size;
+		allocate_vertices(gfx, min_vertex_count);
 
 		if (!index_allocation) {
+			VmaAllocationCreateInfo ai = {};
+			ai.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+			VkBufferCreateInfo bi = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 			bi.size = (max_vertex_count * 6) / 4 * sizeof(fs::u16);
 			bi.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 			ai.flags = 0;
@@ -89,99 +192,144 @@ struct Chunk_Mesh {
 	}
 	auto destroy(fs::Graphics& gfx) -> void {
 		vmaDestroyBuffer(gfx.allocator, vertex_buffer, vertex_allocation);
+		total_vertex_gpu_memory -= vertex_capacity * sizeof(vertex);
 		if (index_allocation) {
 			vmaDestroyBuffer(gfx.allocator, index_buffer, index_allocation);
 			index_allocation = nullptr;
+			for (auto& r : retired_buffers) vmaDestroyBuffer(gfx.allocator, r.buffer, r.allocation);
+			retired_buffers.clear();
 		}
 	}
 
-	struct Upload_Context {
-		vertex* vertex_data;
-		fs::u16* index_data;
-		int vertex_count;
-	};
-
-	auto upload_begin(fs::Graphics& gfx) -> Upload_Context {
-		ready_to_render = false;
-		index_count = 0;
-		vertex * vd;
-		vmaMapMemory(gfx.allocator, vertex_allocation, (void**)&vd);
-		used_vertex_gpu_memory -= bytes_used;
-		total_number_of_quads -= number_of_quads;
-		number_of_quads = 0;
-		return { vd, nullptr, 0 };
+	// Render thread, once per frame: destroys the retired buffers no frame can be drawing from anymore.
+	static auto end_frame(fs::Graphics& gfx) -> void {
+		++frame;
+		std::erase_if(retired_buffers, [&](Retired_Buffer const& r) {
+			if (frame - r.frame < retire_frames) return false;
+			vmaDestroyBuffer(gfx.allocator, r.buffer, r.allocation);
+			return true;
+		});
 	}
-	auto upload_end(fs::Graphics& gfx, Upload_Context& ctx) -> void {
-		vmaUnmapMemory(gfx.allocator, vertex_allocation);
-		vmaFlushAllocation(gfx.allocator, vertex_allocation, 0, ctx.vertex_count * sizeof(vertex));
-		bytes_used = ctx.vertex_count * sizeof(vertex);
-		used_vertex_gpu_memory += bytes_used;
-		total_number_of_quads += number_of_quads;
-		ready_to_render = true;
+
+	// Replaces the vertex buffer with one of `capacity` vertices, the old one is retired.
+	auto allocate_vertices(fs::Graphics& gfx, fs::u32 capacity) -> void {
+		VmaAllocationCreateInfo ai = {};
+		ai.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+		ai.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+		VkBufferCreateInfo bi = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bi.size = capacity * sizeof(vertex);
+		bi.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+		if (vertex_allocation) {
+			retired_buffers.push_back({ vertex_buffer, vertex_allocation, frame });
+			total_vertex_gpu_memory -= vertex_capacity * sizeof(vertex);
+		}
+		auto vkr = vmaCreateBuffer(gfx.allocator, &bi, &ai, &vertex_buffer, &vertex_allocation, nullptr);
+		if (vkr) {
+			VmaTotalStatistics stats;
+			vmaCalculateStatistics(gfx.allocator, &stats);
+			__debugbreak();
+		}
+		vertex_capacity = capacity;
+		total_vertex_gpu_memory += bi.size;
 	}
 
-	auto add_chunk_quads (Upload_Context& ctx, std::vector<quad>& quads, int oy) {
-		auto& [vd, id, vertex_count] = ctx;
-		for (auto const& q : quads) {
-			auto na = q.normal_axis;
+	// Render thread only. Lays the column out from scratch, in a buffer that fits it with its slack.
+	// Distant coarse meshes have few quads, so they take far less than the nearby ones.
+	auto upload(fs::Graphics& gfx, Mesh_Data const& data) -> void {
+		int quad_count = data.number_of_quads;
+		if (quad_count * 4 > max_vertex_count) {
+			ran_out_of_memory = true;
+			quad_count = max_vertex_count / 4;
+		}
 
-			if (na < 0) {
-				na += 3;
-			}
+		// grows right away, shrinks only once it is four times too big so a mesh that goes back
+		// and forth around a size does not reallocate every time
+		int slack_sections = 1;
+		for_n (s, world_chunk_height) slack_sections += data.section_quads[s] != 0;
+		auto wanted = std::clamp(std::bit_ceil(fs::u32(quad_count + slack_sections * section_slack) * 4), min_vertex_count, max_vertex_count);
+		if (wanted > vertex_capacity || wanted * 4 <= vertex_capacity)
+			allocate_vertices(gfx, wanted);
 
-			union vec3 {
-				char comp[4];
-				struct {
-					char x, y, z, _;
-				};
-			};
-			vec3 p00, p01, p10, p11;
-			int i_axis = (na + 1) % 3;
-			int j_axis = (na + 2) % 3;
+		// slack goes to sections that have faces and the one above the highest of them,
+		// that is where edits land; the others need a full rebuild to grow
+		int spare = int(vertex_capacity / 4) - quad_count;
+		int slack = std::min(section_slack, spare / slack_sections);
 
-			p00.comp[na] = q.slice;
-			p00.comp[i_axis] = q.i0;
-			p00.comp[j_axis] = q.j0;
+		vertex* vd;
+		vmaMapMemory(gfx.allocator, vertex_allocation, (void**)&vd);
+		int first = 0, source = 0;
+		for_n (s, world_chunk_height) {
+			int quads = std::min(data.section_quads[s], quad_count - source);
+			int capacity = quads + ((data.section_quads[s] || s == data.open_section) ? slack : 0);
+			memcpy(vd + first * 4, data.vertices.data() + source * 4, quads * 4 * sizeof(vertex));
+			std::fill_n(vd + (first + quads) * 4, (capacity - quads) * 4, vertex{});
+			section_first[s] = (fs::u16)first;
+			section_quads[s] = (fs::u16)quads;
+			first  += capacity;
+			source += quads;
+		}
+		section_first[world_chunk_height] = (fs::u16)first;
+		vmaUnmapMemory(gfx.allocator, vertex_allocation);
+		vmaFlushAllocation(gfx.allocator, vertex_allocation, 0, first * 4 * sizeof(vertex));
 
-			p01.comp[na] = q.slice;
-			p01.comp[i_axis] = q.i0;
-			p01.comp[j_axis] = q.j1;
+		set_counts(quad_count, first);
+		full_rebuild_pending = false;
+		ready_to_render = true;
+	}
 
-			p10.comp[na] = q.slice;
-			p10.comp[i_axis] = q.i1;
-			p10.comp[j_axis] = q.j0;
+	// Render thread only. Rewrites one section in its range,
+	// returns false when it outgrew the range and the column needs a full upload.
+	auto upload_section(fs::Graphics& gfx, Mesh_Data const& data) -> bool {
+		int s = data.section;
+		int first = section_first[s];
+		int capacity = section_first[s + 1] - first;
+		int quads = data.number_of_quads;
+		if (quads > capacity) return false;
 
-			p11.comp[na] = q.slice;
-			p11.comp[i_axis] = q.i1;
-			p11.comp[j_axis] = q.j1;
+		vertex* vd;
+		vmaMapMemory(gfx.allocator, vertex_allocation, (void**)&vd);
+		memcpy(vd + first * 4, data.vertices.data(), quads * 4 * sizeof(vertex));
+		std::fill_n(vd + (first + quads) * 4, (capacity - quads) * 4, vertex{});
+		vmaUnmapMemory(gfx.allocator, vertex_allocation);
+		vmaFlushAllocation(gfx.allocator, vertex_allocation, first * 4 * sizeof(vertex), capacity * 4 * sizeof(vertex));
 
-			float normal = 0.5f + float(q.normal_axis + 3);
-			float u1 = float(q.i1 - q.i0), v1 = float(q.j1 - q.j0);
-			if (q.normal_axis >= 0) {
-				vd[vertex_count++] = { fs::v3f32(float(p00.x), float(p00.y + oy), float(p00.z)), {0.0f, 0.0f, normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p01.x), float(p01.y + oy), float(p01.z)), {0.0f, v1  , normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p11.x), float(p11.y + oy), float(p11.z)), {u1  , v1  , normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p10.x), float(p10.y + oy), float(p10.z)), {u1  , 0.0f, normal} };
-			} else {
-				vd[vertex_count++] = { fs::v3f32(float(p01.x), float(p01.y + oy), float(p01.z)), {0.0f, v1  , normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p00.x), float(p00.y + oy), float(p00.z)), {0.0f, 0.0f, normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p10.x), float(p10.y + oy), float(p10.z)), {u1  , 0.0f, normal} };
-				vd[vertex_count++] = { fs::v3f32(float(p11.x), float(p11.y + oy), float(p11.z)), {u1  , v1  , normal} };
-			}
-		}
-		index_count += 6 * (int)quads.size();
-		number_of_quads += (int)quads.size();
+		int total = number_of_quads - section_quads[s] + quads;
+		section_quads[s] = (fs::u16)quads;
+		set_counts(total, section_first[world_chunk_height]);
+		return true;
+	}
 
-		if (number_of_quads * 4 > max_vertex_count)
-			ran_out_of_memory = true;
-	};
+	// `drawn_quads` includes padding, the index count has to cover the whole layout
+	auto set_counts(int quad_count, int drawn_quads) -> void {
+		used_vertex_gpu_memory -= bytes_used;
+		total_number_of_quads  -= number_of_quads;
+		bytes_used      = drawn_quads * 4 * sizeof(vertex);
+		number_of_quads = quad_count;
+		index_count     = drawn_quads * 6;
+		used_vertex_gpu_memory += bytes_used;
+		total_number_of_quads  += number_of_quads;
+	}
 
-	auto draw(fs::Render_Context* ctx) -> void {
+	// Draws the sections whose ring slot has its bit set in `slots`, one call per run of neighboring slots.
+	auto draw(fs::Render_Context* ctx, fs::u32 slots = ~fs::u32(0)) -> void {
 		if (!ready_to_render) return;
 		VkDeviceSize offset = 0;
 		vkCmdBindIndexBuffer(ctx->command_buffer, index_buffer, 0, VK_INDEX_TYPE_UINT16);
 		vkCmdBindVertexBuffers(ctx->command_buffer, 0, 1, &vertex_buffer, &offset);
-		vkCmdDrawIndexed(ctx->command_buffer, index_count, 1, 0, 0, 0);
+		constexpr auto all = fs::u32((uint64_t(1) << world_chunk_height) - 1);
+		if ((slots & all) == all) {
+			vkCmdDrawIndexed(ctx->command_buffer, index_count, 1, 0, 0, 0);
+			return;
+		}
+		for (int s = 0; s < world_chunk_height; ) {
+			if (!((slots >> s) & 1)) { ++s; continue; }
+			int end = s;
+			while (end < world_chunk_height && ((slots >> end) & 1)) ++end;
+			int first = section_first[s], quads = section_first[end] - first;
+			if (quads) vkCmdDrawIndexed(ctx->command_buffer, quads * 6, 1, first * 6, 0, 0);
+			s = end;
+		}
 	}
 };
 
@@ -199,20 +347,81 @@ struct Semaphore {
 	}
 };
 
+// Column indices (into World::chunk_columns) that a mesh job reads from, and the vertical window
+// they hold. Captured when the job is queued so the meshing thread never looks at `xz_map`.
+struct Mesh_Columns {
+	int base;
+	int pos_x, neg_x;
+	int pos_z, neg_z;
+	int bottom; // world section at the bottom of the window
+	int lod;    // voxels are downsampled 2^lod times, see World::lod_at
+	fs::u8 skirts; // bit per neighbor (pos_x, neg_x, pos_z, neg_z) at another lod, its side is closed off
+};
+
+// Completed mesh handed from the meshing thread back to the render thread.
+struct Mesh_Completion {
+	int          mesh_index;
+	fs::u32      ticket;
+	fs::u32      section_ticket;
+	fs::u32      edit_serial;
+	Mesh_Columns columns;
+	Mesh_Data    data;
+};
+
 struct Chunk_Generation_Thread_Info {
 	struct Work {
-		Chunk_Mesh* mesh;
-		int x, z;
+		int          mesh_index;
+		fs::u32      ticket;
+		Mesh_Columns columns;
+		int          section        = -1; // -1 meshes the whole column
+		fs::u32      section_ticket = 0;
+		fs::u32      edit_serial    = 0;
 	};
 
-	bool active = true;
-	bool working = false;
+	std::atomic<bool> active  = true;
+	std::atomic<bool> working = false;
+	std::atomic<bool> cancel  = false; // set while the render thread waits for the current job to stop
 	struct World* world;
-	std::vector<Work> work_queue;
+	std::vector<Work> work_queue; // guarded by `mutex`
 	
 	Semaphore semaphore;
 
 	std::condition_variable cv;
+	std::condition_variable idle; // notified when `working` goes false
+	std::mutex mutex;
+};
+
+// Column loads, generation and region writes, kept off the render thread.
+// The render thread hands over one batch per recenter. Batches run in order, and a batch's mesh
+// jobs only go to the meshing thread once all of its columns are filled.
+struct Column_IO_Thread_Info {
+	// A vertical run of sections of one column: `sections` of them starting at world section `offset.y`.
+	struct Column_Job {
+		int       column_index;
+		fs::v3s32 offset;
+		int       sections = world_chunk_height;
+		fs::u32   fill_serial = 0; // see World::Chunk_Column, not used by writes
+	};
+	struct Batch {
+		std::vector<Column_Job> columns;
+		std::vector<Chunk_Generation_Thread_Info::Work> meshes;
+		std::vector<Column_Job> dirty; // edited sections to write back to their regions
+		int bottom = 0; // window bottom when the batch was queued
+		bool bulk = false; // the whole window, see World::process_bulk_batch
+
+		// chunk volume to pull into memory once the batch is done, ahead of where the camera is going
+		fs::v3s32 prefetch_min = {}, prefetch_max = {};
+	};
+
+	std::atomic<bool> active  = true;
+	std::atomic<bool> working = false;
+	struct World* world;
+	std::deque<Batch> batches; // guarded by `mutex`
+	std::atomic<int>  filled_bottom = 0; // window bottom of the last batch whose columns are filled
+	std::atomic<bool> cancel = false;    // set while the render thread waits for the current batch to stop, and for good by ~World
+
+	std::condition_variable cv;
+	std::condition_variable idle; // notified when `working` goes false
 	std::mutex mutex;
 };
 
@@ -221,44 +430,217 @@ struct World {
 
 	int render_radius;
 
-	fs::v3s32 chunk_offset;
+	// Chunks past the render radius whose columns and meshes stay loaded but are not drawn. The window
+	// only recenters once the camera is further than this from its center, so walking back and forth
+	// over a chunk border regenerates nothing.
+	int retention_margin;
 
+	// chunk location of the window's corner, y is the lowest world section it holds
+	fs::v3s32 chunk_offset;
+	fs::v3s32 window_center; // camera chunk the window was last centered on
+	fs::v3s32 lod_center;    // camera chunk the meshes' detail was last picked for, see lod_at
+
+	// The sections of one column inside the vertical window, world section cy lives in ring slot
+	// section_slot(cy). Moving the window only refills the slots of the sections that entered it.
+	//
+	// The io thread fills columns (generated or loaded) and the render thread edits them, while the
+	// meshing thread and the io thread's bulk builds and region writes read them:
+	// - Every fill the render thread queues gets a serial, the io thread stores it in `filled_serial`
+	//   with release once the fill is in. The render thread only reads or edits a column whose last
+	//   queued fill is in (see column_at), so it never sees one half filled and never edits one that
+	//   is being filled.
+	// - Everything else can be reading a column while it is refilled or edited, it copies what it
+	//   needs with `snapshot`, which starts over when a write overlapped the copy (a seqlock on
+	//   `version`). Writers store the masks and flags with atomics between begin_write and end_write.
 	struct Chunk_Column {
+		uint64_t      y[world_chunk_height][8];   // the masks, a word per voxel layer (Chunk_Mask's rows y*8 to y*8+7)
+		Block_Section types[world_chunk_height]; // per voxel, only meaningful where `y` is set, see block_types_mutex
+
+		// bit s is set when slot s is all air / all solid, neither means mixed
+		std::atomic<fs::u32> empty_sections = 0;
+		std::atomic<fs::u32> full_sections  = 0;
+		// bit s is set when slot s was edited, its types are stored with it and no longer follow its
+		// shape; only touched by the column's current writer (see begin_write)
+		fs::u32              edited_sections = 0;
+
+		std::atomic<fs::u32> version = 0;       // odd while a writer is in the masks
+		fs::u32              fill_serial = 0;   // render thread, fills queued for the column so far
+		std::atomic<fs::u32> filled_serial = 0; // the last of them that is in
+
+		auto mask(int slot) -> fs::byte* { return reinterpret_cast<fs::byte*>(y[slot]); }
+		auto ready() const -> bool { return filled_serial.load(std::memory_order_acquire) == fill_serial; }
+	};
+	static_assert(world_chunk_height <= 32);
+
+	// A column's masks and flags as they were at one point, see Chunk_Column.
+	struct Column_Snapshot {
 		Chunk_Mask y[world_chunk_height];
+		fs::u32    empty_sections;
+		fs::u32    full_sections;
 	};
 
-	std::vector<Chunk_Column> chunk_columns;
+	static auto snapshot(Chunk_Column& column, Column_Snapshot& out) -> void {
+		while (true) {
+			auto version = column.version.load(std::memory_order_acquire);
+			if (!(version & 1)) {
+				for_n (s, world_chunk_height)
+				for_n (l, 8) {
+					uint64_t layer = std::atomic_ref(column.y[s][l]).load(std::memory_order_relaxed);
+					memcpy(out.y[s] + l * 8, &layer, sizeof(layer));
+				}
+				out.empty_sections = column.empty_sections.load(std::memory_order_relaxed);
+				out.full_sections  = column.full_sections.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (column.version.load(std::memory_order_relaxed) == version) return;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	// Writes to a column's masks and flags go between these. One writer at a time: the io thread
+	// while a fill is queued, the render thread otherwise.
+	static auto begin_write(Chunk_Column& column) -> void {
+		column.version.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+	static auto end_write(Chunk_Column& column) -> void {
+		column.version.fetch_add(1, std::memory_order_release);
+	}
+	static auto store_mask(Chunk_Column& column, int slot, fs::byte const* mask) -> void {
+		for_n (l, 8) {
+			uint64_t layer;
+			memcpy(&layer, mask + l * 8, sizeof(layer));
+			std::atomic_ref(column.y[slot][l]).store(layer, std::memory_order_relaxed);
+		}
+	}
+
+	static auto section_slot(int cy) -> int {
+		int r = cy % world_chunk_height;
+		return r + world_chunk_height * (r < 0);
+	}
+
+	// Writer only, between begin_write and end_write.
+	static auto update_section_flags(Chunk_Column& column, int s) -> void {
+		uint64_t any = 0, all = ~uint64_t(0);
+		for (auto r : column.y[s]) { any |= r; all &= r; }
+		auto bit = fs::u32(1) << s;
+		auto empty = column.empty_sections.load(std::memory_order_relaxed);
+		auto full  = column.full_sections.load(std::memory_order_relaxed);
+		column.empty_sections.store((any == 0)            ? (empty | bit) : (empty & ~bit), std::memory_order_relaxed);
+		column.full_sections.store( (all == ~uint64_t(0)) ? (full  | bit) : (full  & ~bit), std::memory_order_relaxed);
+	}
+
+	std::vector<Chunk_Column> chunk_columns; // sized once, the atomics keep columns in place
 
-	std::vector<int> xz_map; // maps (x,z) location to chunk column index
+	// Held while Block_Section storage is written (edits, refilled columns) or read off the render
+	// thread, palette storage can be reallocated under a reader. The masks are covered by
+	// Chunk_Column's version instead.
+	std::mutex block_types_mutex;
+
+	std::vector<int> xz_map;   // maps (x,z) location to chunk column index
+	std::vector<int> mesh_map; // maps (x,z) render location to mesh index
 	std::vector<Chunk_Mesh> meshes;
 
+	Mpsc_Ring<Mesh_Completion, 1024> completed_meshes;
+
+	// horizon culling, render thread only
+	bool    horizon_culling = use_horizon_culling;
+	Horizon horizon{ horizon_bins };
+	std::vector<fs::u8> hidden; // per render location, set by cull for the draws after it
+	int     columns_hidden = 0;
+	int     columns_tested = 0;
+	double  cull_seconds   = 0.0;
+
+	// cave culling, render thread only
+	bool    cave_culling = use_cave_culling;
+	Cave_Culling caves;
+	std::vector<fs::u32> visible_sections; // per render location, a bit per ring slot the camera can see into
+	int     sections_reachable = 0;
+	double  cave_seconds = 0.0;
+
+	Quad_Cache quad_cache{ size_t(quad_cache_max_entries) }; // chunks with the same content share their quads
+	std::unique_ptr<Mesh_Store> mesh_store; // behind quad_cache, null when meshes are not persisted
+
+	std::unique_ptr<Terrain_Generator> generator;
+	std::unique_ptr<Region_Store>      region_store; // null when columns are not persisted
+
 	Chunk_Generation_Thread_Info info;
 	std::jthread meshing_thread;
 
+	// block edits, render thread only
+	struct Pending_Edit {
+		int         mesh_index;
+		fs::u32     serial; // visible once a result with this edit_serial or later is uploaded
+		decltype(fs::timestamp()) time;
+	};
+	std::vector<Pending_Edit> pending_edits; // remeshes not visible yet
+	std::vector<Column_IO_Thread_Info::Column_Job> dirty_columns; // edited since the last flush_edits
+	double last_edit_latency = 0.0; // seconds from set_block until the new mesh is uploaded
+	double max_edit_latency  = 0.0;
+
+	Column_IO_Thread_Info io;
+	std::jthread io_thread; // declared last so it is joined first, it feeds the meshing thread
+
 	World() {
 		render_radius = render_chunk_radius;
 
+		// as wide as configured, as long as the extra columns and vertex buffers fit under the cap;
+		// the retained meshes are at the edge, where they are coarse and small
+		int64_t bytes_per_column = sizeof(Chunk_Column) + Chunk_Mesh::max_vertex_count / 4 * sizeof(vertex);
+		retention_margin = 0;
+		while (retention_margin < retention_chunks) {
+			int wider = (render_radius + retention_margin + 1) * 2 + 1;
+			int64_t extra = (int64_t(SQ(wider)) - SQ((render_radius * 2 + 1))) * bytes_per_column;
+			if (extra > int64_t(retention_memory_cap_mib) << 20) break;
+			++retention_margin;
+		}
+
 		int c_diameter = chunk_diameter();
+		chunk_columns = std::vector<Chunk_Column>(SQ(c_diameter));
 		for (int z = 0; z < c_diameter; ++z)
-		for (int x = 0; x < c_diameter; ++x) {
-			chunk_columns.emplace_back();
+		for (int x = 0; x < c_diameter; ++x)
 			xz_map.emplace_back(MAP2D(x,z,c_diameter));
-		}
+
+		// terrain.txt picks the world type without rebuilding: "<name> <seed>"
+		std::string generator_name = terrain_generator;
+		int seed = terrain_seed;
+		if (auto f = std::ifstream("terrain.txt"))
+			f >> generator_name >> seed;
+		generator = create_terrain_generator(generator_name.c_str(), seed);
+		if (!generator) generator = create_terrain_generator("mountains", seed);
+		open_region_store();
+		// keyed by content alone, so one file serves every world type
+		if (use_mesh_store)
+			mesh_store = std::make_unique<Mesh_Store>(std::filesystem::path(region_directory) / "meshes.bin", size_t(mesh_store_max_mib) << 20);
 
 		info.world = this;
 		meshing_thread = std::jthread(chunk_generation_thread_main, &info);
+		io.world = this;
+		io_thread = std::jthread(column_io_thread_main, &io);
 	}
 
 	~World() {
-		info.active = false;
+		// a bulk build in progress stops at its next group, or while it waits on the full ring
+		io.cancel = true;
+		{
+			std::scoped_lock lock{io.mutex};
+			io.active = false;
+		}
+		io.cv.notify_one();
+		{
+			std::scoped_lock lock{info.mutex};
+			info.active = false;
+		}
 		info.cv.notify_one();
 	}
 
 	auto create(fs::Graphics& gfx) -> void {
-		meshes.reserve(SQ(render_diameter()));
-		FS_FOR(SQ(render_diameter())) {
+		int r_diameter = mesh_diameter();
+		meshes.reserve(SQ(r_diameter));
+		FS_FOR(SQ(r_diameter)) {
 			meshes.emplace_back();
 			meshes.back().create(gfx);
+			mesh_map.emplace_back(i);
 		}
 	}
 	auto destroy(fs::Graphics& gfx) -> void {
@@ -266,8 +648,76 @@ struct World {
 			mesh.destroy(gfx);
 	}
 
-	auto render_diameter() -> int { return render_radius * 2 + 1; }
-	auto chunk_diameter()  -> int { return render_radius * 2 + 3; }
+	// meshes are kept for the retention margin too, columns one further to give them neighbors
+	auto mesh_radius()    -> int { return render_radius + retention_margin; }
+	auto mesh_diameter()  -> int { return mesh_radius() * 2 + 1; }
+	auto chunk_diameter() -> int { return mesh_radius() * 2 + 3; }
+
+	// True once the camera in chunk `chunk_position` is further from the window's center than the
+	// retention margin sideways, or than `vertical_hysteresis` sections up or down.
+	auto needs_recenter(fs::v3s32 chunk_position) -> bool {
+		return std::abs(chunk_position.x - window_center.x) > retention_margin
+			|| std::abs(chunk_position.z - window_center.z) > retention_margin
+			|| std::abs(chunk_position.y - window_center.y) > vertical_hysteresis;
+	}
+
+	// Where a camera in chunk `camera_chunk` moving at `velocity` (voxels per second) will be in
+	// `prefetch_seconds`, as far as it can be while the camera's render radius stays in the window.
+	auto predicted_center(fs::v3s32 camera_chunk, glm::vec3 velocity) -> fs::v3s32 {
+		auto lead = velocity * (prefetch_seconds / 8.0f);
+		auto chunks = [](float v, int limit) { return std::clamp(int(std::round(v)), -limit, limit); };
+		return camera_chunk + fs::v3s32(chunks(lead.x, retention_margin), chunks(lead.y, vertical_hysteresis), chunks(lead.z, retention_margin));
+	}
+
+	// Neither background thread has anything queued or running.
+	auto background_idle() -> bool {
+		{
+			std::scoped_lock lock{io.mutex};
+			if (io.working || !io.batches.empty()) return false;
+		}
+		std::scoped_lock lock{info.mutex};
+		return !info.working && info.work_queue.empty();
+	}
+
+	// Render thread only, before build_window. recenter_chunks moves it later.
+	auto center_window(fs::v3s32 chunk_position) -> void {
+		window_center = chunk_position;
+		lod_center    = chunk_position;
+		chunk_offset  = window_offset(chunk_position);
+	}
+
+	// Render thread, every frame before recenter_chunks. Meshes get their detail from their distance
+	// to the camera, not to the window's center: when the camera moves to another chunk the meshes
+	// whose level or skirts change are rebuilt, nearly all of them along the rings between levels.
+	auto update_detail(fs::v3s32 camera_chunk) -> void {
+		if (camera_chunk.x == lod_center.x && camera_chunk.z == lod_center.z) return;
+		lod_center = camera_chunk;
+
+		int r_diameter = mesh_diameter();
+		std::vector<Chunk_Generation_Thread_Info::Work> work;
+		for (int z = 0; z < r_diameter; ++z)
+		for (int x = 0; x < r_diameter; ++x) {
+			int mesh_index = mesh_map[MAP2D(x, z, r_diameter)];
+			auto& mesh = meshes[mesh_index];
+			auto columns = mesh_columns(x, z);
+			if (columns.lod == mesh.lod && columns.skirts == mesh.skirts) continue;
+			mesh.full_rebuild_pending = true;
+			mesh.lod    = columns.lod;
+			mesh.skirts = columns.skirts;
+			work.push_back({ mesh_index, ++mesh.ticket, columns, -1, 0, mesh.edit_serial });
+		}
+		if (work.empty()) return;
+
+		// through the io thread, so they go behind any columns it is still filling
+		Column_IO_Thread_Info::Batch batch;
+		batch.bottom = chunk_offset.y;
+		batch.meshes = std::move(work);
+		{
+			std::scoped_lock lock{io.mutex};
+			io.batches.push_back(std::move(batch));
+		}
+		io.cv.notify_one();
+	}
 
 	auto recenter_chunks(fs::Graphics& gfx, fs::v3s32 chunk_position) -> void {
 		auto euclidean_remainder = [](int a, int b) -> int {
@@ -276,7 +726,16 @@ struct World {
 		};
 
 		// 1. calculate new chunk offset
-		auto new_chunk_offset = fs::v3s32(chunk_position.x - render_radius, 0, chunk_position.z - render_radius);
+		auto new_chunk_offset = window_offset(chunk_position);
+		{
+			auto jump = new_chunk_offset - chunk_offset;
+			int c_diameter = chunk_diameter();
+			if (std::abs(jump.x) >= c_diameter || std::abs(jump.z) >= c_diameter || std::abs(jump.y) >= world_chunk_height) {
+				teleport(chunk_position);
+				return;
+			}
+		}
+		window_center = chunk_position;
 		
 		// 2. move chunks to be consistant with the new chunk offset
 		// this move vector describes how to move the chunks
@@ -284,12 +743,18 @@ struct World {
 		// this look vector describes the offset to the chunk that replaces any given chunk
 		auto look = new_chunk_offset - chunk_offset;
 		int c_diameter = chunk_diameter();
-		
-		{
-			std::scoped_lock lock{info.mutex};
+
+		Column_IO_Thread_Info::Batch batch;
+		batch.bottom = new_chunk_offset.y;
+
+		// sections that enter the vertical window, every column that stays refills just these
+		int entering_first = new_chunk_offset.y, entering_count = world_chunk_height;
+		if (std::abs(look.y) < world_chunk_height) {
+			entering_count = std::abs(look.y);
+			entering_first = (look.y > 0) ? chunk_offset.y + world_chunk_height : new_chunk_offset.y;
 		}
 
-		// 3. calculate chunk data for all new chunks
+		// 3. find the columns that need new data, the io thread fills them
 		std::vector<int> new_xz_map;
 		new_xz_map.reserve(xz_map.size());
 		for (int z = 0; z < c_diameter; ++z)
@@ -305,201 +770,953 @@ struct World {
 			new_xz_map.emplace_back(xz_map[MAP2D(lx, lz, c_diameter)]);
 
 			// need to regenerate chunk block mask
-			if (!good) {
-				auto column_index = new_xz_map.back();
-				generate_chunk_column(chunk_columns[column_index], {x + new_chunk_offset.x, 0, z + new_chunk_offset.z});
-			}
+			if (!good)
+				batch.columns.push_back(fill_job(new_xz_map.back(), {x + new_chunk_offset.x, new_chunk_offset.y, z + new_chunk_offset.z}));
+			else if (entering_count)
+				batch.columns.push_back(fill_job(new_xz_map.back(), {x + new_chunk_offset.x, entering_first, z + new_chunk_offset.z}, entering_count));
 		}
 		std::swap(xz_map, new_xz_map);
+		chunk_offset = new_chunk_offset;
 
-		// 4. calculate mesh data for all new chunks
-		std::vector<Chunk_Mesh> new_meshes;
-		new_meshes.resize(meshes.size());
+		// 4. queue mesh jobs for all new meshes, they run after their columns are filled
+		std::vector<int> new_mesh_map;
+		new_mesh_map.reserve(mesh_map.size());
 
-		fs::u8 default_mask[8 * 8] = {};
-		memset(default_mask, 0xFF, sizeof(default_mask));
-		
-		int r_diameter = render_diameter();
+		int r_diameter = mesh_diameter();
 		for (int z = 0; z < r_diameter; ++z)
 		for (int x = 0; x < r_diameter; ++x) {
 			int lx = x + look.x;
 			int lz = z + look.z;
-	
+		
 			bool good = (lx >= 0 && lx < r_diameter && lz >= 0 && lz < r_diameter);
-	
+		
 			lx = euclidean_remainder(lx, r_diameter);
 			lz = euclidean_remainder(lz, r_diameter);
-	
-			new_meshes[MAP2D(x, z, r_diameter)] = meshes[MAP2D(lx, lz, r_diameter)];
+		
+			new_mesh_map.emplace_back(mesh_map[MAP2D(lx, lz, r_diameter)]);
 			
 			// need to regenerate mesh
+			auto mesh_index = new_mesh_map.back();
+			auto& mesh = meshes[mesh_index];
+			auto columns = mesh_columns(x, z);
 			if (!good) {
-		//		generate_mesh(gfx, x, z, new_meshes[MAP2D(x, z, r_diameter)], default_mask);
-				Chunk_Generation_Thread_Info::Work work;
-				work.mesh = &new_meshes[MAP2D(x, z, r_diameter)];
-				work.x = x;
-				work.z = z;
-				info.work_queue.push_back(work);
-				work.mesh->ready_to_render = false;
+				mesh.ready_to_render = false;
+				mesh.full_rebuild_pending = true;
+				mesh.lod    = columns.lod;
+				mesh.skirts = columns.skirts;
+				batch.meshes.push_back({ mesh_index, ++mesh.ticket, columns });
+				continue;
+			}
+			// kept meshes that moved to another distance from the center change their detail,
+			// including ones whose rebuild is still queued at the old one
+			bool relod = columns.lod != mesh.lod || columns.skirts != mesh.skirts;
+			if (entering_count || relod) {
+				// the entering sections, and the one next to them that used to be the window's edge
+				if (!mesh.ready_to_render || mesh.full_rebuild_pending || entering_count == world_chunk_height || relod) {
+					mesh.full_rebuild_pending = true;
+					mesh.lod    = columns.lod;
+					mesh.skirts = columns.skirts;
+					batch.meshes.push_back({ mesh_index, ++mesh.ticket, columns, -1, 0, mesh.edit_serial });
+					continue;
+				}
+				int edge = (look.y > 0) ? entering_first - 1 : entering_first + entering_count;
+				for (int cy = entering_first; cy < entering_first + entering_count; ++cy) {
+					int slot = section_slot(cy);
+					batch.meshes.push_back({ mesh_index, mesh.ticket, columns, slot, ++mesh.section_tickets[slot], mesh.edit_serial });
+				}
+				batch.meshes.push_back({ mesh_index, mesh.ticket, columns, section_slot(edge), ++mesh.section_tickets[section_slot(edge)], mesh.edit_serial });
 			}
+		}
+		std::swap(mesh_map, new_mesh_map);
+
+		// edited meshes that just left the window will never show up
+		std::erase_if(pending_edits, [&](auto& e) { return !meshes[e.mesh_index].ready_to_render; });
 
+		// 5. prefetch the window one region further along the direction of travel
+		auto sign = [](int v) { return (v > 0) - (v < 0); };
+		auto ahead = fs::v3s32(sign(look.x) * Region_Store::region_size, sign(look.y) * Region_Store::region_height, sign(look.z) * Region_Store::region_size);
+		batch.prefetch_min = chunk_offset + ahead;
+		batch.prefetch_max = batch.prefetch_min + fs::v3s32(c_diameter, world_chunk_height, c_diameter);
+
+		{
+			std::scoped_lock lock{io.mutex};
+			io.batches.push_back(std::move(batch));
 		}
-		std::swap(meshes, new_meshes);
+		io.cv.notify_one();
+	}
 
-		chunk_offset = new_chunk_offset;
+	// Io thread: fill a batch's columns, then hand its meshes to the meshing thread
+	// and write the newly generated and edited columns out while they mesh.
+	auto process_io_batch(Column_IO_Thread_Info::Batch& batch) -> void {
+		struct Store_Job {
+			Column_IO_Thread_Info::Column_Job job;
+			fs::u32 sections; // bit i is section job.offset.y + i
+			bool    edited = false;
+		};
+		std::vector<Store_Job> to_store;
+		if (batch.bulk) {
+			auto generated = process_bulk_batch(batch);
+			if (io.cancel) return;
+			for (size_t i = 0; i < batch.columns.size(); ++i)
+				if (generated[i]) to_store.push_back({ batch.columns[i], generated[i] });
+		}
+		else {
+			for (auto& job : batch.columns)
+				if (auto generated = fill_chunk_column(job, batch.bottom))
+					to_store.push_back({ job, generated });
+			io.filled_bottom = batch.bottom;
+
+			if (!batch.meshes.empty()) {
+				{
+					std::scoped_lock lock{info.mutex};
+					info.work_queue.insert(info.work_queue.end(), batch.meshes.begin(), batch.meshes.end());
+				}
+				info.cv.notify_one();
+			}
+		}
 
-		info.cv.notify_one();
+		if (!region_store) return;
+		for (auto& job : batch.dirty)
+			to_store.push_back({ job, fs::u32((uint64_t(1) << job.sections) - 1), true });
+		for (auto& [job, sections, edited] : to_store)
+			store_sections(chunk_columns[job.column_index], job, sections, edited);
+		region_store->prefetch(batch.prefetch_min.x, batch.prefetch_min.z, batch.prefetch_max.x, batch.prefetch_max.z,
+			batch.prefetch_min.y, batch.prefetch_max.y);
+	}
+
+	// Io thread: fills a batch that covers the whole window on every core and meshes it right there.
+	// Columns and meshes come nearest first; columns go in groups, and after each group every mesh
+	// whose five columns are in is built, also in parallel, and handed to the render thread. So the
+	// chunks around the camera show up while the rest of the window is still loading.
+	// Returns a bit per generated section for every column job.
+	auto process_bulk_batch(Column_IO_Thread_Info::Batch& batch) -> std::vector<fs::u32> {
+		constexpr size_t group_size = 256;
+		std::vector<fs::u32> generated(batch.columns.size());
+		std::vector<char>    filled(chunk_columns.size(), 0);
+		std::vector<Mesh_Completion> completions;
+
+		auto columns_in = [&](Mesh_Columns const& c) {
+			return filled[c.base] && filled[c.pos_x] && filled[c.neg_x] && filled[c.pos_z] && filled[c.neg_z];
+		};
+
+		size_t next_mesh = 0;
+		for (size_t first = 0; first < batch.columns.size() || next_mesh < batch.meshes.size(); first += group_size) {
+			if (io.cancel) break;
+			size_t last = std::min(first + group_size, batch.columns.size());
+			std::for_each(std::execution::par, batch.columns.begin() + first, batch.columns.begin() + last, [&](auto& job) {
+				generated[&job - batch.columns.data()] = fill_chunk_column(job, batch.bottom);
+			});
+			for (size_t i = first; i < last; ++i) filled[batch.columns[i].column_index] = 1;
+			bool all_filled = last == batch.columns.size();
+			if (all_filled) io.filled_bottom = batch.bottom;
+
+			size_t ready = next_mesh;
+			while (ready < batch.meshes.size() && (all_filled || columns_in(batch.meshes[ready].columns))) ++ready;
+			completions.resize(ready - next_mesh);
+			for (size_t i = 0; i < completions.size(); ++i) {
+				auto& work = batch.meshes[next_mesh + i];
+				completions[i].mesh_index     = work.mesh_index;
+				completions[i].ticket         = work.ticket;
+				completions[i].section_ticket = 0;
+				completions[i].edit_serial    = work.edit_serial;
+				completions[i].columns        = work.columns;
+			}
+			std::for_each(std::execution::par, completions.begin(), completions.end(), [&](Mesh_Completion& completion) {
+				build_mesh(completion.columns, completion.data);
+			});
+			for (auto& completion : completions) {
+				// the render thread drains the ring every frame, unless it is waiting for us to stop
+				while (!completed_meshes.try_push(std::move(completion))) {
+					if (io.cancel) return generated;
+					std::this_thread::yield();
+				}
+			}
+			next_mesh = ready;
+		}
+		return generated;
 	}
 
-	auto generate_mesh(fs::Graphics& gfx, int x, int z, Chunk_Mesh& mesh, fs::byte* default_mask) -> void {
+	// Drops queued work and waits until neither thread touches the columns. Render thread only.
+	// With `keep_edit_writes` the batches that write edited sections back stay queued (only that
+	// part of them), they do not touch the columns until they run and keep their place in line.
+	auto stop_background_work(bool keep_edit_writes = false) -> void {
+		{
+			std::scoped_lock lock{io.mutex};
+			if (keep_edit_writes) {
+				std::erase_if(io.batches, [](auto& batch) { return batch.dirty.empty(); });
+				for (auto& batch : io.batches) {
+					batch.columns.clear();
+					batch.meshes.clear();
+					batch.bulk = false;
+					batch.prefetch_min = batch.prefetch_max = {};
+				}
+			}
+			else io.batches.clear();
+		}
+		io.cancel = true;
+		{
+			std::unique_lock lock{io.mutex};
+			io.idle.wait(lock, [this] { return !io.working; });
+		}
+		io.cancel = false;
+		// the ring is not drained while we wait, a job stuck on a full ring drops its result
+		info.cancel = true;
+		{
+			std::unique_lock lock{info.mutex};
+			info.work_queue.clear();
+			info.idle.wait(lock, [this] { return !info.working; });
+		}
+		info.cancel = false;
+	}
+
+	// Render thread: take every finished mesh off the completion ring and make it visible.
+	// Called once per frame before drawing, never waits on the meshing thread.
+	auto publish_completed_meshes(fs::Graphics& gfx) -> void {
+		Mesh_Completion completion;
+		while (completed_meshes.try_pop(completion)) {
+			auto& mesh = meshes[completion.mesh_index];
+			if (mesh.ticket != completion.ticket) continue; // mesh was reassigned while in flight
+
+			int section = completion.data.section;
+			if (section < 0) {
+				mesh.upload(gfx, completion.data);
+			}
+			else if (mesh.section_tickets[section] != completion.section_ticket)
+				continue; // the section was edited again, a newer result is coming
+			else if (!mesh.upload_section(gfx, completion.data)) {
+				// the window may have moved up or down since, a mesh that stayed keeps its columns
+				auto columns = completion.columns;
+				columns.bottom = chunk_offset.y;
+				queue_full_rebuild(completion.mesh_index, columns);
+				info.cv.notify_one();
+				continue;
+			}
+			mesh.solid_top = completion.data.solid_top;
+			mesh.top       = completion.data.top;
+			if (section < 0)
+				memcpy(mesh.section_connectivity, completion.data.section_connectivity, sizeof(mesh.section_connectivity));
+			else
+				mesh.section_connectivity[section] = completion.data.section_connectivity[section];
+
+			for (size_t i = 0; i < pending_edits.size(); ) {
+				auto& edit = pending_edits[i];
+				if (edit.mesh_index == completion.mesh_index && edit.serial <= completion.edit_serial) {
+					last_edit_latency = fs::seconds_elasped(edit.time, fs::timestamp());
+					max_edit_latency  = std::max(max_edit_latency, last_edit_latency);
+					pending_edits[i] = pending_edits.back();
+					pending_edits.pop_back();
+				}
+				else ++i;
+			}
+		}
+	}
+
+	// The mesh outgrew its section layout or has section work that a full rebuild would race with.
+	// Caller notifies the meshing thread. While the io thread still has sections of the current
+	// window to fill, the job goes behind them so it does not mesh the old ones.
+	auto queue_full_rebuild(int mesh_index, Mesh_Columns const& columns) -> void {
+		auto& mesh = meshes[mesh_index];
+		mesh.full_rebuild_pending = true;
+		mesh.lod    = columns.lod;
+		mesh.skirts = columns.skirts;
+		Chunk_Generation_Thread_Info::Work work = { mesh_index, ++mesh.ticket, columns, -1, 0, mesh.edit_serial };
+		if (io.filled_bottom != columns.bottom) {
+			Column_IO_Thread_Info::Batch batch;
+			batch.bottom = columns.bottom;
+			batch.meshes.push_back(work);
+			{
+				std::scoped_lock lock{io.mutex};
+				io.batches.push_back(std::move(batch));
+			}
+			io.cv.notify_one();
+			return;
+		}
+		std::scoped_lock lock{info.mutex};
+		info.work_queue.push_back(work);
+	}
+
+	// Render thread: the job that refills sections [offset.y, offset.y + sections) of column `index`,
+	// the column is not read or edited again until the io thread has run it.
+	auto fill_job(int index, fs::v3s32 offset, int sections = world_chunk_height) -> Column_IO_Thread_Info::Column_Job {
+		return { index, offset, sections, ++chunk_columns[index].fill_serial };
+	}
+
+	// Column holding world voxel (x, z), null when it is outside the loaded window or its fill is not
+	// in yet. Render thread only (or while it waits, see raycast).
+	auto column_at(int x, int z) -> Chunk_Column* {
 		int c_diameter = chunk_diameter();
-		int r_diameter = render_diameter();
+		int lx = (x >> 3) - chunk_offset.x;
+		int lz = (z >> 3) - chunk_offset.z;
+		if (lx < 0 || lx >= c_diameter || lz < 0 || lz >= c_diameter) return nullptr;
+		auto& column = chunk_columns[xz_map[MAP2D(lx, lz, c_diameter)]];
+		return column.ready() ? &column : nullptr;
+	}
 
-		std::vector<quad> quads;
-		quads.reserve(1 << 10);
-		adjacent_chunks adj;
+	// Slot of the section holding world voxel layer y, -1 when it is outside the vertical window.
+	auto slot_at(int y) -> int {
+		int cy = y >> 3;
+		if (cy < chunk_offset.y || cy >= chunk_offset.y + world_chunk_height) return -1;
+		return section_slot(cy);
+	}
 
-		fs::byte empty[8*8] = {};
+	auto raycast_column(int cx, int cz) -> Raycast_Column {
+		auto column = column_at(cx * 8, cz * 8);
+		if (!column) return {};
+		return { column->mask(0), world_chunk_height, chunk_offset.y, column->empty_sections.load(std::memory_order_relaxed) };
+	}
 
-		auto base_column_index = xz_map[MAP2D((x + 1), (z + 1), c_diameter)];
-		auto& column = chunk_columns[base_column_index];
-
-		auto pos_x_column_index = xz_map[MAP2D((x), (z + 1), c_diameter)];
-		auto neg_x_column_index = xz_map[MAP2D((x + 2), (z + 1), c_diameter)];
-		auto pos_z_column_index = xz_map[MAP2D((x + 1), (z), c_diameter)];
-		auto neg_z_column_index = xz_map[MAP2D((x + 1), (z + 2), c_diameter)];
-
-		auto ctx = mesh.upload_begin(gfx);
-		for_n(y, world_chunk_height) {
-			adj.pos[0] = chunk_columns[pos_x_column_index].y[y];
-			adj.pos[2] = chunk_columns[pos_z_column_index].y[y];
-			adj.neg[0] = chunk_columns[neg_x_column_index].y[y];
-			adj.neg[2] = chunk_columns[neg_z_column_index].y[y];
-			adj.pos[1] = (y == 0) ? default_mask : column.y[y - 1];
-			adj.neg[1] = (y == world_chunk_height-1) ? empty : column.y[y + 1];
-			generate_quads_for_chunk(column.y[y], &adj, quads);
-			mesh.add_chunk_quads(ctx, quads, y * 8);
-			quads.clear();
+	// Rays in world voxel coordinates, they stop at the edge of the loaded window and at columns that
+	// are still being filled. The batch traces on several threads while the render thread waits.
+	auto raycast(Ray const& ray) -> Ray_Hit {
+		return ::raycast(ray, [this](int cx, int cz) { return raycast_column(cx, cz); });
+	}
+	auto raycast(Ray const* rays, int count, Ray_Hit* hits) -> void {
+		raycast_batch(rays, count, hits, [this](int cx, int cz) { return raycast_column(cx, cz); });
+	}
+
+	// Meshes are drawn one column over from the camera's own chunk (see mesh_columns),
+	// so the voxel under the camera on screen is its position moved by one column.
+	static auto camera_to_world(glm::vec3 camera_position) -> glm::vec3 {
+		return camera_position + glm::vec3(8.0f, 0.0f, 8.0f);
+	}
+
+	// Random rays from `origin`, reports how many million rays per second `raycast` traces.
+	struct Raycast_Benchmark {
+		int    rays = 0;
+		double seconds = 0.0;
+		int    hits = 0;
+	};
+	auto benchmark_raycast(glm::vec3 origin, int count = 1 << 18, float max_distance = 256.0f) -> Raycast_Benchmark {
+		std::mt19937 rng(1234);
+		std::normal_distribution<float> normal;
+		std::vector<Ray> rays(count);
+		std::vector<Ray_Hit> hits(count);
+		for (auto& ray : rays)
+			ray = { origin, glm::normalize(glm::vec3(normal(rng), normal(rng), normal(rng))), max_distance };
+
+		auto start = fs::timestamp();
+		raycast(rays.data(), count, hits.data());
+		Raycast_Benchmark result;
+		result.seconds = fs::seconds_elasped(start, fs::timestamp());
+		result.rays = count;
+		for (auto& hit : hits) result.hits += hit.hit;
+		return result;
+	}
+
+	// False for air and for anything outside the loaded window.
+	auto get_block(int x, int y, int z) -> bool {
+		auto column = column_at(x, z);
+		int slot = slot_at(y);
+		if (!column || slot < 0) return false;
+		return (column->mask(slot)[(y & 7)*8 + (z & 7)] >> (x & 7)) & 1;
+	}
+
+	// Type of the block at (x, y, z), whatever was last there for air.
+	auto get_block_type(int x, int y, int z) -> Block_Type {
+		auto column = column_at(x, z);
+		int slot = slot_at(y);
+		if (!column || slot < 0) return block_stone;
+		return column->types[slot].get((y & 7)*64 + (z & 7)*8 + (x & 7));
+	}
+
+	// Render thread only. Remeshes the edited 8x8x8 section and, when the voxel is on the section's
+	// edge, the neighboring section that shares that face; everything else keeps its quads.
+	// Returns false when the voxel is outside the loaded window.
+	auto set_block(int x, int y, int z, bool solid, Block_Type type = block_placed) -> bool {
+		auto column = column_at(x, z);
+		int slot = slot_at(y);
+		if (!column || slot < 0) return false;
+
+		// the meshing thread may be copying this column, the word goes in whole
+		auto& layer = column->y[slot][y & 7];
+		auto bit = uint64_t(1) << ((z & 7)*8 + (x & 7));
+		if (bool(layer & bit) == solid) return true;
+		begin_write(*column);
+		std::atomic_ref(layer).store(solid ? (layer | bit) : (layer & ~bit), std::memory_order_relaxed);
+		update_section_flags(*column, slot);
+		end_write(*column);
+		column->edited_sections |= fs::u32(1) << slot; // its types are stored from now on
+		if (solid) {
+			std::scoped_lock lock{block_types_mutex};
+			column->types[slot].set((y & 7)*64 + (z & 7)*8 + (x & 7), type);
 		}
-		mesh.upload_end(gfx, ctx);
+
+		auto now = fs::timestamp();
+		int cx = x >> 3, cz = z >> 3, cy = y >> 3;
+		auto remesh = [&](int cx, int cy, int cz) {
+			// columns are offset by one in render space, see mesh_columns
+			int rx = cx - chunk_offset.x - 1;
+			int rz = cz - chunk_offset.z - 1;
+			int r_diameter = mesh_diameter();
+			if (rx < 0 || rx >= r_diameter || rz < 0 || rz >= r_diameter) return;
+
+			int mesh_index = mesh_map[MAP2D(rx, rz, r_diameter)];
+			auto& mesh = meshes[mesh_index];
+			++mesh.edit_serial;
+			if (!mesh.ready_to_render || mesh.full_rebuild_pending) {
+				queue_full_rebuild(mesh_index, mesh_columns(rx, rz));
+			}
+			else {
+				// keeps drawing the old quads until the new ones land,
+				// the meshing thread takes work from the back so edits go next
+				int slot = section_slot(cy);
+				std::scoped_lock lock{info.mutex};
+				info.work_queue.push_back({ mesh_index, mesh.ticket, mesh_columns(rx, rz), slot, ++mesh.section_tickets[slot], mesh.edit_serial });
+			}
+
+			// a mesh edited again before it showed up is measured from the first edit
+			auto pending = std::find_if(pending_edits.begin(), pending_edits.end(), [&](auto& e) { return e.mesh_index == mesh_index; });
+			if (pending != pending_edits.end()) pending->serial = mesh.edit_serial;
+			else pending_edits.push_back({ mesh_index, mesh.edit_serial, now });
+		};
+		// the voxel's own section, and every section that shares a face with it
+		remesh(cx, cy, cz);
+		if ((x & 7) == 0) remesh(cx - 1, cy, cz);
+		if ((x & 7) == 7) remesh(cx + 1, cy, cz);
+		if ((z & 7) == 0) remesh(cx, cy, cz - 1);
+		if ((z & 7) == 7) remesh(cx, cy, cz + 1);
+		if ((y & 7) == 0 && cy > chunk_offset.y)                          remesh(cx, cy - 1, cz);
+		if ((y & 7) == 7 && cy < chunk_offset.y + world_chunk_height - 1) remesh(cx, cy + 1, cz);
+		info.cv.notify_one();
+
+		fs::v3s32 offset = { cx, cy, cz };
+		auto index = int(column - chunk_columns.data());
+		if (std::none_of(dirty_columns.begin(), dirty_columns.end(), [&](auto& job) { return job.column_index == index && job.offset.y == cy; }))
+			dirty_columns.push_back({ index, offset, 1 });
+		return true;
 	}
 
-	auto draw(fs::Render_Context* ctx, VkPipelineLayout layout) {
-		int r_diameter = render_diameter();
-		for (int z = 0; z < r_diameter; ++z)
-		for (int x = 0; x < r_diameter; ++x) {
-			auto& mesh = meshes[MAP2D(x, z, r_diameter)];
-			glm::vec4 pos = glm::vec4(float(x), 0.0f, float(z), 0.0);
-			vkCmdPushConstants(
-				ctx->command_buffer,
-				layout,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				64,
-				sizeof(pos),
-				&pos
-			);
-			mesh.draw(ctx);
+	// Hands this frame's edited columns to the io thread in one batch.
+	auto flush_edits() -> void {
+		if (dirty_columns.empty() || !region_store) {
+			dirty_columns.clear();
+			return;
+		}
+		Column_IO_Thread_Info::Batch batch;
+		batch.bottom = chunk_offset.y;
+		batch.dirty = std::move(dirty_columns);
+		dirty_columns.clear();
+		{
+			std::scoped_lock lock{io.mutex};
+			io.batches.push_back(std::move(batch));
 		}
+		io.cv.notify_one();
 	}
 
-	auto generate_mesh_for_all_chunks(fs::Graphics& gfx) -> void {
-		total_number_of_quads = 0;
-		int r_diameter = render_diameter();
+	// (x,z) is the location in render space, columns are offset by one to leave room for neighbors.
+	auto mesh_columns(int x, int z) -> Mesh_Columns {
 		int c_diameter = chunk_diameter();
+		return {
+			.base  = xz_map[MAP2D((x + 1), (z + 1), c_diameter)],
+			.pos_x = xz_map[MAP2D((x    ), (z + 1), c_diameter)],
+			.neg_x = xz_map[MAP2D((x + 2), (z + 1), c_diameter)],
+			.pos_z = xz_map[MAP2D((x + 1), (z    ), c_diameter)],
+			.neg_z = xz_map[MAP2D((x + 1), (z + 2), c_diameter)],
+			.bottom = chunk_offset.y,
+			.lod    = lod_at(x, z),
+			.skirts = fs::u8((lod_at(x - 1, z) != lod_at(x, z)) | (lod_at(x + 1, z) != lod_at(x, z)) << 1
+				| (lod_at(x, z - 1) != lod_at(x, z)) << 2 | (lod_at(x, z + 1) != lod_at(x, z)) << 3),
+		};
+	}
+
+	// Downsampling of the mesh at render location (x, z): 0 (full resolution) near the camera's
+	// chunk (lod_center), each level after that halves the resolution and starts twice as far out.
+	// Sides between levels are meshed as if the neighbor were air so the two never leave a crack.
+	// A coarse cell is solid where any of its voxels is, so the coarse side stands up to 2^lod - 1
+	// voxels above its finer neighbor and its wall faces the camera on the fine side: these steps
+	// are visible along the rings between levels.
+	auto lod_at(int x, int z) -> int {
+		if (lod_distance <= 0) return 0;
+		// columns are offset by one in render space, see mesh_columns
+		int distance = std::max(std::abs(x + 1 + chunk_offset.x - lod_center.x), std::abs(z + 1 + chunk_offset.z - lod_center.z));
+		int level = 0;
+		while (level < 3 && distance >= (lod_distance << level)) ++level;
+		return level;
+	}
 
-		fs::u8 default_mask[8 * 8] = {};
-		memset(default_mask, 0xFF, sizeof(default_mask));
+	// Window corner for a camera in chunk `chunk_position`, centered on it in all three directions.
+	auto window_offset(fs::v3s32 chunk_position) -> fs::v3s32 {
+		return { chunk_position.x - mesh_radius(), chunk_position.y - world_chunk_height / 2, chunk_position.z - mesh_radius() };
+	}
 
-#if 0
-		struct Thread_Info {
-			int x, z;
-			Chunk_Mesh* mesh;
-			Chunk_Mesh::Upload_Context ctx;
+	// Layers the column is solid up to from the window's `bottom`, and the layer above its highest voxel.
+	static auto column_heights(Column_Snapshot const& column, int bottom, int& solid_top, int& top) -> void {
+		auto layer = [&](int slot, int ly) -> uint64_t {
+			uint64_t bits;
+			memcpy(&bits, column.y[slot] + ly * 8, sizeof(bits));
+			return bits;
 		};
-		std::vector<Thread_Info> infos;
-		infos.reserve(r_diameter * r_diameter);
-		for (int z = 0; z < r_diameter; ++z)
-		for (int x = 0; x < r_diameter; ++x) {
-			auto& mesh = meshes[MAP2D(x, z, r_diameter)];
-			infos.emplace_back(x, z, &mesh, mesh.upload_begin(gfx));
-		}
-		std::for_each(std::execution::par, infos.begin(), infos.end(), [&](Thread_Info& info) {
-			auto& [x, z, mesh, ctx] = info;
-			auto base_column_index = xz_map[MAP2D((x+1),(z+1),c_diameter)];
-			auto& column = chunk_columns[base_column_index];
-
-			auto pos_x_column_index = xz_map[MAP2D((x  ),(z+1),c_diameter)];
-			auto neg_x_column_index = xz_map[MAP2D((x+2),(z+1),c_diameter)];
-			auto pos_z_column_index = xz_map[MAP2D((x+1),(z  ),c_diameter)];
-			auto neg_z_column_index = xz_map[MAP2D((x+1),(z+2),c_diameter)];
-
-			std::vector<quad> quads;
-			for_n (y, world_chunk_height) {
-				adjacent_chunks adj;
-				adj.pos[0] = chunk_columns[pos_x_column_index].y[y];
-				adj.pos[2] = chunk_columns[pos_z_column_index].y[y];
-				adj.neg[0] = chunk_columns[neg_x_column_index].y[y];
-				adj.neg[2] = chunk_columns[neg_z_column_index].y[y];
-				adj.pos[1] = (y==0)? default_mask : column.y[y-1];
-				adj.neg[1] = (y==world_chunk_height-1)? default_mask : column.y[y+1];
-				generate_quads_for_chunk(column.y[y], &adj, quads);
-				mesh->add_chunk_quads(ctx, quads, y*8);
-				quads.clear();
+		solid_top = bottom * 8;
+		for (int cy = bottom; cy < bottom + world_chunk_height; ++cy) {
+			int slot = section_slot(cy);
+			if ((column.full_sections >> slot) & 1) {
+				solid_top = (cy + 1) * 8;
+				continue;
 			}
-		});
-		for (auto& info: infos) {
-			info.mesh->upload_end(gfx, info.ctx);
+			for (int ly = 0; ly < 8 && layer(slot, ly) == ~uint64_t(0); ++ly)
+				solid_top = cy * 8 + ly + 1;
+			break;
 		}
-#else
+		top = bottom * 8;
+		for (int cy = bottom + world_chunk_height - 1; cy >= bottom; --cy) {
+			int slot = section_slot(cy);
+			if ((column.empty_sections >> slot) & 1) continue;
+			int ly = 7;
+			while (ly > 0 && layer(slot, ly) == 0) --ly;
+			top = cy * 8 + ly + 1;
+			break;
+		}
+	}
+
+	// Safe to call from any thread, only reads `chunk_columns`.
+	// `section` -1 meshes every section, otherwise only the one in that ring slot. Below the window
+	// counts as solid and above it as air, the sections at its edges are remeshed when it moves.
+	auto build_mesh(Mesh_Columns const& columns, Mesh_Data& data, int section = -1) -> void {
 		std::vector<quad> quads;
 		quads.reserve(1 << 10);
-		for (int z = 0; z < r_diameter; ++z)
-		for (int x = 0; x < r_diameter; ++x) {
-			generate_mesh(gfx, x, z, meshes[MAP2D(x, z, r_diameter)], default_mask);
+		adjacent_chunks adj;
+
+		fs::byte empty[8*8] = {};
+		fs::byte solid[8*8];
+		memset(solid, 0xFF, sizeof(solid));
+
+		// the columns can be refilled or edited while we mesh, the result is dropped then (see the tickets)
+		Column_Snapshot column, around[4];
+		snapshot(chunk_columns[columns.base], column);
+		int neighbors[4] = { columns.pos_x, columns.neg_x, columns.pos_z, columns.neg_z };
+		for_n (i, 4)
+			if (!((columns.skirts >> i) & 1)) snapshot(chunk_columns[neighbors[i]], around[i]);
+		int bottom = columns.bottom, top = columns.bottom + world_chunk_height - 1;
+
+		// full sections with full neighbors on all six sides make no faces
+		fs::u32 full_around = column.full_sections;
+		for_n (i, 4)
+			full_around &= ((columns.skirts >> i) & 1) ? 0 : around[i].full_sections;
+
+		Block_Type types[Block_Section::voxel_count];
+		fs::u8     keys[Block_Section::voxel_count];
+		Quad_Cache::Key cache_key;
+
+		// downsampled copies of the section and what is next to it, when the mesh is coarser
+		int f = 1 << columns.lod;
+		fs::byte lod_masks[7][8*8];
+		auto coarse = [&](fs::byte* mask, fs::byte* out) -> fs::byte* {
+			if (f == 1 || mask == solid || mask == empty) return mask;
+			downsample_mask(mask, f, out);
+			return out;
+		};
+
+		data.clear();
+		data.section = section;
+		data.vertices.reserve(section < 0 ? 1 << 11 : 1 << 8);
+		column_heights(column, bottom, data.solid_top, data.top);
+		data.top = (data.top + (1 << columns.lod) - 1) & ~((1 << columns.lod) - 1); // coarse cells reach up to the next multiple
+		int highest = bottom - 1; // highest section with faces
+		for_n(slot, world_chunk_height) {
+			if (section >= 0 && slot != section) continue;
+			data.section_connectivity[slot] = ((column.empty_sections >> slot) & 1) ? all_faces_connected
+				: ((column.full_sections >> slot) & 1) ? 0 : face_connectivity(column.y[slot]);
+			if ((column.empty_sections >> slot) & 1) continue;
+			int cy = bottom + section_slot(slot - bottom);
+			int below = section_slot(cy - 1), above = section_slot(cy + 1);
+			bool buried = ((full_around >> slot) & 1) && (cy == bottom || ((column.full_sections >> below) & 1))
+				&& cy != top && ((column.full_sections >> above) & 1);
+			if (buried) continue;
+			auto side = [&](int i) { return ((columns.skirts >> i) & 1) ? empty : coarse(around[i].y[slot], lod_masks[i]); };
+			adj.pos[0] = side(0);
+			adj.neg[0] = side(1);
+			adj.pos[2] = side(2);
+			adj.neg[2] = side(3);
+			adj.pos[1] = coarse((cy == bottom) ? solid : column.y[below], lod_masks[4]);
+			adj.neg[1] = coarse((cy == top)    ? empty : column.y[above], lod_masks[5]);
+			fs::byte* mask = coarse(column.y[slot], lod_masks[6]);
+			{
+				std::scoped_lock lock{block_types_mutex};
+				chunk_columns[columns.base].types[slot].decode(types);
+			}
+			if (f == 1) chunk_keys(column.y[slot], types, keys);
+			else        downsample_keys(column.y[slot], types, f, keys);
+			// the key covers the downsampled voxels, coarse chunks share entries like full ones
+			Quad_Cache::chunk_key(keys, adj, cache_key);
+			auto hash = cache_key.hash();
+			if (!quad_cache.find(cache_key, hash, quads)) {
+				if (!mesh_store || !mesh_store->load(cache_key, hash, quads)) {
+					generate_quads_for_chunk(mask, keys, &adj, quads, (column.full_sections >> slot) & 1);
+					if (mesh_store) mesh_store->store(cache_key, hash, quads);
+				}
+				quad_cache.insert(cache_key, hash, quads);
+			}
+			data.add_chunk_quads(quads, cy * 8);
+			data.section_quads[slot] = (int)quads.size();
+			if (!quads.empty()) highest = std::max(highest, cy);
+			quads.clear();
+		}
+		if (highest >= bottom && highest < top) data.open_section = section_slot(highest + 1);
+	}
+
+	// The camera jumped somewhere none of the window can be kept (T, a spawn or a teleport): drops all
+	// queued work, the window moves in one go and is rebuilt from the middle out. recenter_chunks
+	// comes here by itself when nothing would survive the move. Render thread only.
+	auto teleport(fs::v3s32 chunk_position) -> void {
+		stop_background_work(true); // edits still go to disk before their sections are replaced
+		pending_edits.clear();
+		center_window(chunk_position);
+		build_window();
+	}
+
+	// Refills every column and remeshes every mesh of the window, nearest to its center first, on the
+	// io thread with all cores (see process_bulk_batch). Meshes show up as they finish, the render
+	// thread never waits for the build. Render thread only.
+	auto build_window() -> void {
+		build_timing = { fs::timestamp() };
+
+		Column_IO_Thread_Info::Batch batch;
+		batch.bulk   = true;
+		batch.bottom = chunk_offset.y;
+
+		// every location of a square window, spiraling out from its center
+		auto nearest_first = [](int diameter) {
+			std::vector<fs::v2s32> order;
+			order.reserve(SQ(diameter));
+			for (int z = 0; z < diameter; ++z)
+			for (int x = 0; x < diameter; ++x)
+				order.push_back({ x, z });
+			int c = diameter / 2;
+			std::stable_sort(order.begin(), order.end(), [c](fs::v2s32 a, fs::v2s32 b) {
+				return SQ((a.x - c)) + SQ((a.y - c)) < SQ((b.x - c)) + SQ((b.y - c));
+			});
+			return order;
+		};
+
+		int c_diameter = chunk_diameter();
+		batch.columns.reserve(SQ(c_diameter));
+		for (auto [x, z] : nearest_first(c_diameter))
+			batch.columns.push_back(fill_job(xz_map[MAP2D(x, z, c_diameter)], { x + chunk_offset.x, chunk_offset.y, z + chunk_offset.z }));
+
+		int r_diameter = mesh_diameter();
+		batch.meshes.reserve(SQ(r_diameter));
+		for (auto [x, z] : nearest_first(r_diameter)) {
+			auto mesh_index = mesh_map[MAP2D(x, z, r_diameter)];
+			auto& mesh = meshes[mesh_index];
+			mesh.ready_to_render = false;
+			mesh.full_rebuild_pending = true;
+			auto columns = mesh_columns(x, z);
+			mesh.lod    = columns.lod;
+			mesh.skirts = columns.skirts;
+			batch.meshes.push_back({ mesh_index, ++mesh.ticket, columns, -1, 0, mesh.edit_serial });
+		}
+
+		{
+			std::scoped_lock lock{io.mutex};
+			io.batches.push_back(std::move(batch));
+		}
+		io.cv.notify_one();
+	}
+
+	// How long the last build_window took to show something, and to finish.
+	struct Build_Timing {
+		decltype(fs::timestamp()) start;
+		double nearest_mesh = 0.0; // seconds until the mesh under the camera is visible
+		double full_window  = 0.0; // until every mesh in the window is
+		bool   finished     = false;
+	};
+	Build_Timing build_timing = { fs::timestamp(), 0.0, 0.0, true };
+
+	// Render thread, once per frame after publish_completed_meshes.
+	auto update_build_timing() -> void {
+		auto& t = build_timing;
+		if (t.finished) return;
+		double elapsed = fs::seconds_elasped(t.start, fs::timestamp());
+		int center = mesh_radius();
+		if (t.nearest_mesh == 0.0 && meshes[mesh_map[MAP2D(center, center, mesh_diameter())]].ready_to_render)
+			t.nearest_mesh = elapsed;
+		if (std::all_of(meshes.begin(), meshes.end(), [](Chunk_Mesh const& mesh) { return mesh.ready_to_render; })) {
+			t.full_window = elapsed;
+			t.finished = true;
 		}
-#endif
 	}
 
-	auto generate_all_chunks () -> void {
+	// Swaps the world type and regenerates everything around the current offset.
+	// Render thread only, waits for the background threads to finish their current job.
+	auto set_generator(fs::Graphics& gfx, std::unique_ptr<Terrain_Generator> new_generator) -> void {
+		stop_background_work();
+		pending_edits.clear();
+		dirty_columns.clear();
+
+		generator = std::move(new_generator);
+		open_region_store();
+		build_window();
+	}
+
+	// Every world type and seed gets its own directory of region files.
+	auto open_region_store() -> void {
+		region_store.reset();
+		if (!use_region_store) return;
+		auto name = std::format("{}_{}", generator->name(), generator->seed);
+		// room for the regions under the window plus the ones prefetched ahead of it
+		int regions_across = chunk_diameter() / Region_Store::region_size + 2;
+		int regions_up     = world_chunk_height / Region_Store::region_height + 2;
+		region_store = std::make_unique<Region_Store>(std::filesystem::path(region_directory) / name, size_t(2 * SQ(regions_across) * regions_up));
+	}
+
+	// Times generating every column in the window against loading the same columns from disk.
+	// Results go to scratch memory, the world is left untouched.
+	struct Region_Benchmark {
+		int    columns = 0;
+		double generate_seconds = 0.0;
+		double load_seconds     = 0.0;
+	};
+	auto benchmark_region_store() -> Region_Benchmark {
+		Region_Benchmark result;
+		if (!region_store) return result;
+
+		Chunk_Mask scratch[world_chunk_height];
+		Terrain_Column terrain = { &scratch[0][0], world_chunk_height, 0, 0, chunk_offset.y };
 		int c_diameter = chunk_diameter();
+		result.columns = c_diameter * c_diameter;
+
+		auto start = fs::timestamp();
 		for (int z = 0; z < c_diameter; ++z)
 		for (int x = 0; x < c_diameter; ++x) {
-			auto column_index = xz_map[MAP2D(x,z,c_diameter)];
-			generate_chunk_column(chunk_columns[column_index], {x + chunk_offset.x, 0, z + chunk_offset.z});
+			memset(scratch, 0, sizeof(scratch));
+			generator->generate((x + chunk_offset.x)*8, (z + chunk_offset.z)*8, terrain);
 		}
+		result.generate_seconds = fs::seconds_elasped(start, fs::timestamp());
+
+		start = fs::timestamp();
+		for (int z = 0; z < c_diameter; ++z)
+		for (int x = 0; x < c_diameter; ++x)
+			region_store->load(x + chunk_offset.x, z + chunk_offset.z, terrain);
+		result.load_seconds = fs::seconds_elasped(start, fs::timestamp());
+		return result;
 	}
 
-	auto generate_chunk_column (Chunk_Column& column, fs::v3s32 offset) -> void {
-#if TERRAIN != TERRAIN_BLOBS
-		float height_field[64];
-		for (int z = 0; z < 8; ++z)
-		for (int x = 0; x < 8; ++x)
-		{
-			height_field[z*8 + x] = terrain_height_from_location(x + offset.x*8, z + offset.z*8);
+	// Memory of the block types in the window, the occupancy masks included.
+	struct Block_Type_Memory {
+		int64_t sections = 0;
+		int64_t uniform_sections = 0; // a single type, no palette storage
+		int64_t bytes = 0;
+	};
+	auto block_type_memory() -> Block_Type_Memory {
+		Block_Type_Memory result;
+		std::scoped_lock lock{block_types_mutex}; // the io thread may be filling columns
+		for (auto& column : chunk_columns)
+		for (auto& types : column.types) {
+			result.sections += 1;
+			result.uniform_sections += types.index_bits == 0;
+			result.bytes += sizeof(Chunk_Mask) + sizeof(Block_Section) + types.heap_bytes();
 		}
-#endif
-	
-		memset(&column, 0, sizeof(column));
-
-		auto perlin_noise = [](int x, int y, int z) { return stb_perlin_noise3(float(x)/64.0f,float(y)/64.0f,float(z)/64.0f,0,0,0); };
+		return result;
+	}
 
-		for_n (cy, world_chunk_height) {
-			auto block_mask = column.y[cy];
+	// Works out what the next draws can skip, for a camera at `eye` (its position, drawn relative
+	// to its chunk like Camera_Controller::get_position) looking through `view_projection`.
+	// Render thread only.
+	auto cull(glm::vec3 eye, fs::v3s32 camera_chunk, glm::mat4 const& view_projection) -> void {
+		cull_horizon(eye, camera_chunk);
+		cull_caves(camera_chunk, View_Frustum(view_projection));
+	}
 
-			for (int y = 0; y < 8; ++y)
-			for (int z = 0; z < 8; ++z)
-			for (int x = 0; x < 8; ++x)
-			{
-#if TERRAIN != TERRAIN_BLOBS
-				float height = height_field[z*8 + x];
-				if (float(y + cy*8) / 64.0f < height) {
-					block_mask[y*8 + z] |= (1 << x);
+	// Marks the columns around the camera that the terrain in front of them hides. Columns are fed
+	// to the horizon a ring at a time, a ring only tests against the ones inside it since a ray from
+	// the camera crosses the rings in order.
+	auto cull_horizon(glm::vec3 eye, fs::v3s32 camera_chunk) -> void {
+		int r_diameter = mesh_diameter();
+		hidden.assign(size_t(SQ(r_diameter)), 0);
+		columns_hidden = columns_tested = 0;
+		cull_seconds = 0.0;
+		if (!horizon_culling) return;
+
+		auto start = fs::timestamp();
+		int cam_x = camera_chunk.x - chunk_offset.x;
+		int cam_z = camera_chunk.z - chunk_offset.z;
+		float fx = eye.x - float(camera_chunk.x * 8);
+		float fz = eye.z - float(camera_chunk.z * 8);
+
+		struct Occluder {
+			Horizon::Span span;
+			float height;
+		};
+		std::vector<Occluder> ring;
+		horizon.clear();
+		for (int k = 1; k <= render_radius; ++k) {
+			ring.clear();
+			for (int dz = -k; dz <= k; ++dz)
+			for (int dx = -k; dx <= k; dx += (dz == -k || dz == k) ? 1 : 2 * k) {
+				int x = cam_x + dx, z = cam_z + dz;
+				if (x < 0 || z < 0 || x >= r_diameter || z >= r_diameter) continue;
+				auto& mesh = meshes[mesh_map[MAP2D(x, z, r_diameter)]];
+				if (!mesh.ready_to_render) continue;
+
+				Horizon::Span span;
+				float x0 = float(dx * 8) - fx, z0 = float(dz * 8) - fz;
+				if (!horizon.span(x0, z0, x0 + 8.0f, z0 + 8.0f, span)) continue;
+				++columns_tested;
+				if (!horizon.visible(span, float(mesh.top) - eye.y)) {
+					hidden[MAP2D(x, z, r_diameter)] = 1;
+					++columns_hidden;
 				}
-#else
-				block_mask[y * 8 + z] |= ((perlin_noise(x + offset.x*8, y + cy*8, z + offset.z*8) > 0.1f) << x);
-#endif
+				// hidden or not its ground is there, and hides what is behind it
+				ring.push_back({ span, float(mesh.solid_top) - eye.y });
 			}
+			for (auto& o : ring) horizon.occlude(o.span, o.height);
 		}
+		cull_seconds = fs::seconds_elasped(start, fs::timestamp());
+	}
+
+	// Finds the sections in view that can be seen from the camera's section through air, see
+	// cave_culling.hpp. Runs after cull_horizon, the search does not enter the part of a hidden
+	// column below its top.
+	auto cull_caves(fs::v3s32 camera_chunk, View_Frustum const& frustum) -> void {
+		int r_diameter = mesh_diameter();
+		int cam_x = camera_chunk.x - chunk_offset.x;
+		int cam_z = camera_chunk.z - chunk_offset.z;
+		int cam_y = camera_chunk.y - chunk_offset.y;
+		sections_reachable = 0;
+		cave_seconds = 0.0;
+		if (!cave_culling || cam_y < 0 || cam_y >= world_chunk_height || cam_x < 0 || cam_x >= r_diameter || cam_z < 0 || cam_z >= r_diameter) {
+			visible_sections.assign(size_t(SQ(r_diameter)), ~fs::u32(0));
+			return;
+		}
+
+		auto start = fs::timestamp();
+		int bottom = chunk_offset.y;
+		int radius = std::min(render_radius, cave_culling_radius);
+		auto lo = glm::ivec3(std::max(cam_x - radius, 0), 0, std::max(cam_z - radius, 0));
+		auto hi = glm::ivec3(std::min(cam_x + radius + 1, r_diameter), world_chunk_height, std::min(cam_z + radius + 1, r_diameter));
+		// past the search everything is drawn
+		visible_sections.assign(size_t(SQ(r_diameter)), ~fs::u32(0));
+		for (int z = lo.z; z < hi.z; ++z)
+		for (int x = lo.x; x < hi.x; ++x)
+			visible_sections[MAP2D(x, z, r_diameter)] = 0;
+		auto connectivity = [&](int x, int y, int z) -> int {
+			int location = MAP2D(x, z, r_diameter);
+			auto& mesh = meshes[mesh_map[location]];
+			if (hidden[location] && (bottom + y) * 8 < mesh.top) return -1;
+			// where draw puts the section
+			auto corner = glm::vec3(float((x - cam_x + render_radius) * 8), float((bottom + y) * 8), float((z - cam_z + render_radius) * 8));
+			if (!frustum.overlaps(corner, corner + glm::vec3(8.0f))) return -1;
+			if (!mesh.ready_to_render) return all_faces_connected; // nothing known yet, may be open
+			return mesh.section_connectivity[section_slot(bottom + y)];
+		};
+		auto visit = [&](int x, int y, int z) {
+			visible_sections[MAP2D(x, z, r_diameter)] |= fs::u32(1) << section_slot(bottom + y);
+		};
+		sections_reachable = caves.search(glm::ivec3(cam_x, cam_y, cam_z), lo, hi, connectivity, visit);
+		cave_seconds = fs::seconds_elasped(start, fs::timestamp());
+	}
+
+	// Draws the meshes within the render radius of the camera in chunk `camera_chunk`. The camera
+	// sits at render location (render_radius, render_radius), see Camera_Controller::get_position,
+	// and the window can lag it by up to the retention margin.
+	auto draw(fs::Render_Context* ctx, VkPipelineLayout layout, fs::v3s32 camera_chunk) {
+		int r_diameter = mesh_diameter();
+		int cam_x = camera_chunk.x - chunk_offset.x;
+		int cam_z = camera_chunk.z - chunk_offset.z;
+		for (int z = std::max(cam_z - render_radius, 0); z <= std::min(cam_z + render_radius, r_diameter - 1); ++z)
+		for (int x = std::max(cam_x - render_radius, 0); x <= std::min(cam_x + render_radius, r_diameter - 1); ++x) {
+			if (!hidden.empty() && hidden[MAP2D(x, z, r_diameter)]) continue;
+			fs::u32 sections = visible_sections.empty() ? ~fs::u32(0) : visible_sections[MAP2D(x, z, r_diameter)];
+			if (!sections) continue;
+			auto& mesh = meshes[mesh_map[MAP2D(x, z, r_diameter)]];
+			glm::vec4 pos = glm::vec4(float(x - cam_x + render_radius), 0.0f, float(z - cam_z + render_radius), 0.0);
+			vkCmdPushConstants(
+				ctx->command_buffer,
+				layout,
+				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+				64,
+				sizeof(pos),
+				&pos
+			);
+			mesh.draw(ctx, sections);
+		}
+	}
+
+	// Fills sections [offset.y, offset.y + sections) of the job's column, loading the ones its region
+	// has and generating the rest, and publishes the fill (see Chunk_Column). `bottom` is the window the
+	// column is filled for, the sections of it that are not part of the run are already in place.
+	// Returns a bit per section that was generated.
+	auto fill_chunk_column(Column_IO_Thread_Info::Column_Job const& job, int bottom) -> fs::u32 {
+		auto& column = chunk_columns[job.column_index];
+		auto offset = job.offset;
+		int sections = job.sections;
+		Chunk_Mask masks[world_chunk_height] = {};
+		Terrain_Column terrain = { &masks[0][0], sections, 0, 0, offset.y };
+		auto all = fs::u32((uint64_t(1) << sections) - 1);
+		fs::u32 loaded = region_store ? region_store->load(offset.x, offset.z, terrain) : 0;
+		if (loaded != all) {
+			Chunk_Mask generated[world_chunk_height] = {};
+			Terrain_Column run = { &generated[0][0], sections, 0, 0, offset.y };
+			generator->generate(offset.x*8, offset.z*8, run);
+			for_n (i, sections)
+				if (!((loaded >> i) & 1)) memcpy(masks[i], generated[i], sizeof(Chunk_Mask));
+		}
+		update_column_bounds(terrain);
+
+		// types follow the shape, the section right above the run decides where its surface is
+		int top = offset.y + sections;
+		bool has_above = top < bottom + world_chunk_height;
+		Block_Section types[world_chunk_height];
+		assign_block_types(terrain, types, has_above ? column.mask(section_slot(top)) : nullptr);
+
+		// sections that were edited before they were stored keep the types they were given
+		fs::u32 edited = 0;
+		if (loaded) {
+			fs::byte stored[world_chunk_height][Region_Store::type_bytes];
+			edited = region_store->load_types(offset.x, offset.z, offset.y, sections, &stored[0][0], loaded);
+			for_n (i, sections)
+				if (((edited >> i) & 1) && !types[i].deserialize(stored[i])) edited &= ~(fs::u32(1) << i);
+		}
+
+		// a run that entered at the top puts new sections over the old top one, whose surface moves,
+		// unless it was edited
+		Block_Section retyped;
+		int below = section_slot(offset.y - 1);
+		bool retype = offset.y > bottom && !((column.edited_sections >> below) & 1);
+		if (retype) {
+			Terrain_Column old_top = { column.mask(below), 1, 0, 0, offset.y - 1 };
+			update_column_bounds(old_top);
+			assign_block_types(old_top, &retyped, masks[0]);
+		}
+
+		begin_write(column);
+		for_n (i, sections) {
+			int slot = section_slot(offset.y + i);
+			store_mask(column, slot, masks[i]);
+			update_section_flags(column, slot);
+		}
+		end_write(column);
+		{
+			std::scoped_lock lock{block_types_mutex};
+			for_n (i, sections) column.types[section_slot(offset.y + i)] = std::move(types[i]);
+			if (retype) column.types[below] = std::move(retyped);
+		}
+		for_n (i, sections) {
+			auto bit = fs::u32(1) << section_slot(offset.y + i);
+			column.edited_sections = ((edited >> i) & 1) ? (column.edited_sections | bit) : (column.edited_sections & ~bit);
+		}
+		column.filled_serial.store(job.fill_serial, std::memory_order_release);
+		return all & ~loaded;
+	}
+
+	// Writes the sections of the run `job` that have their bit set in `sections` to the column's region,
+	// with their block types when they were `edited`. The render thread may be editing the column meanwhile.
+	auto store_sections(Chunk_Column& column, Column_IO_Thread_Info::Column_Job const& job, fs::u32 sections, bool edited) -> void {
+		Column_Snapshot current;
+		snapshot(column, current);
+		Chunk_Mask masks[world_chunk_height];
+		for_n (i, job.sections) memcpy(masks[i], current.y[section_slot(job.offset.y + i)], sizeof(Chunk_Mask));
+		Terrain_Column terrain = { &masks[0][0], job.sections, 0, 0, job.offset.y };
+		region_store->store(job.offset.x, job.offset.z, terrain, sections);
+		if (!edited) return;
+
+		fs::byte types[world_chunk_height][Region_Store::type_bytes];
+		{
+			std::scoped_lock lock{block_types_mutex};
+			for_n (i, job.sections)
+				if ((sections >> i) & 1) column.types[section_slot(job.offset.y + i)].serialize(types[i]);
+		}
+		region_store->store_types(job.offset.x, job.offset.z, job.offset.y, job.sections, &types[0][0], sections);
 	}
 };
 
@@ -574,11 +1791,6 @@ struct Renderer {
 	VkDescriptorSet atlas_set;
 	VkSampler       atlas_sampler;
 
-	VkImageView     block_types_view;
-	gfx::Image      block_types;
-	VkSampler       sampler;
-	VkDescriptorSet block_types_set;
-
 	Skybox skybox;
 
 	void create(VkRenderPass in_render_pass) {
@@ -587,7 +1799,6 @@ struct Renderer {
 		Pipeline_Layout_Creator{}
 			.add_push_range(VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(transform_data))
 			.add_layout(engine.texture_layout)
-			.add_layout(engine.texture_layout)
 			.create(&pipeline_layout);
 
 		vk::Basic_Vertex_Input<decltype(vertex::position), decltype(vertex::texcoord)> vi{};
@@ -637,7 +1848,6 @@ struct Renderer {
 		vkAllocateDescriptorSets(gfx.device, &desc_info, &atlas_set);
 
 		auto sampler_info = vk::sampler(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER);
-		vkCreateSampler(gfx.device, &sampler_info, nullptr, &sampler);
 		sampler_info.minFilter = VK_FILTER_LINEAR;
 		sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		sampler_info.minLod = 0.0f;// static_cast<float>(ic.image_info.mipLevels - 2); // Optional
@@ -658,83 +1868,13 @@ struct Renderer {
 			vkUpdateDescriptorSets(gfx.device, 1, &write, 0, nullptr);
 		}
 
-		int render_chunk_diameter = 8;
-		{
-			auto format = VK_FORMAT_R8_UINT;
-			
-			VkImageCreateInfo image_info{
-				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-				.imageType = VK_IMAGE_TYPE_3D,
-				.format = format,
-				.extent = {.width = unsigned(render_chunk_diameter)*8, .height = unsigned(world_chunk_height)*8, .depth = unsigned(render_chunk_diameter)*8},
-				.mipLevels = 1,
-				.arrayLayers = 1,
-				.samples = VK_SAMPLE_COUNT_1_BIT,
-				.tiling = VK_IMAGE_TILING_OPTIMAL,
-				.usage = VK_IMAGE_USAGE_SAMPLED_BIT|VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-			};
-			VmaAllocationCreateInfo allocation_info{
-			//	.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-				.usage = VMA_MEMORY_USAGE_AUTO,
-			};
-
-			auto vkr = vmaCreateImage(gfx.allocator, &image_info, &allocation_info, &block_types.image, &block_types.allocation, nullptr);
-
-			upload();
-
-			auto view_info = vk::image_view_2d(block_types.image, format);
-			view_info.viewType = VK_IMAGE_VIEW_TYPE_3D;
-			vkCreateImageView(gfx.device, &view_info, nullptr, &block_types_view);
-		}
-		{
-			VkDescriptorSetAllocateInfo desc_info{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-			desc_info.descriptorPool = engine.descriptor_pool;
-			desc_info.descriptorSetCount = 1;
-			desc_info.pSetLayouts = &engine.texture_layout;
-			vkAllocateDescriptorSets(gfx.device, &desc_info, &block_types_set);
-		}
-		{
-			VkDescriptorImageInfo imageInfo;
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = block_types_view;
-			imageInfo.sampler = sampler;
-			VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			write.descriptorCount = 1;
-			write.dstBinding = 0;
-			write.dstSet = block_types_set;
-			write.pImageInfo = &imageInfo;
-			vkUpdateDescriptorSets(gfx.device, 1, &write, 0, nullptr);
-		}
-
 		skybox.create(gfx, in_render_pass);
 	}
 
-	void upload() {
-		auto& gfx = engine.graphics;
-		int render_chunk_diameter = 8;
-		auto block_type_data = new fs::u8[render_chunk_diameter*render_chunk_diameter*world_chunk_height*8*8*8];
-
-		FS_FOR(render_chunk_diameter*render_chunk_diameter*world_chunk_height*8*8*8) {
-			block_type_data[i] = rand()%8;
-		}
-
-	//	for_n(x, render_chunk_diameter*8)
-	//	for_n(z, render_chunk_diameter*8)
-	//	for_n(y, 8*8) {
-	//		block_type_data[z*render_chunk_diameter*8*8*8 + y*render_chunk_diameter*8 + x]
-	//			= (y)%8;
-	//	}
-
-		gfx.upload_image(block_types.image, block_type_data, {unsigned(render_chunk_diameter)*8,unsigned(world_chunk_height)*8,unsigned(render_chunk_diameter)*8}, VK_FORMAT_R8_UINT);
-	}
-
 	void destroy() {
 		auto& gfx = engine.graphics;
 		vkDestroyPipelineLayout(gfx.device, pipeline_layout, nullptr);
 		vkDestroyImageView(gfx.device, atlas_view, nullptr);
-		vkDestroyImageView(gfx.device, block_types_view, nullptr);
-		vkDestroySampler(gfx.device, sampler, nullptr);
 		vkDestroySampler(gfx.device, atlas_sampler, nullptr);
 		skybox.destroy(gfx);
 	}
@@ -764,28 +1904,28 @@ struct Renderer {
 		transform.eye_position = glm::vec4(cam.get_position(), 0.0f);
 		vkCmdPushConstants_fv(0, sizeof(transform), &transform);
 		
-		VkDescriptorSet sets[] = { atlas_set, block_types_set };
+		VkDescriptorSet sets[] = { atlas_set };
 		FS_VK_BIND_DESCRIPTOR_SETS(ctx.command_buffer, pipeline_layout, vk::count(sets), sets);
 
 #if 1
 		if (wireframe) {
 			if (wireframe_depth) {
 				vkCmdBindPipeline(ctx.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_pipeline);
-				world.draw(&ctx, pipeline_layout);
+				world.draw(&ctx, pipeline_layout, cam.get_chunk_position());
 			}
 			vkCmdBindPipeline(ctx.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, wireframe_pipeline);
-			world.draw(&ctx, pipeline_layout);
+			world.draw(&ctx, pipeline_layout, cam.get_chunk_position());
 		}
 		else {
 			vkCmdBindPipeline(ctx.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-			world.draw(&ctx, pipeline_layout);
+			world.draw(&ctx, pipeline_layout, cam.get_chunk_position());
 		}
 #else
 		vkCmdBindPipeline(ctx.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-		world.draw(&ctx, pipeline_layout);
+		world.draw(&ctx, pipeline_layout, cam.get_chunk_position());
 		if (wireframe) {
 			vkCmdBindPipeline(ctx.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, wireframe_pipeline);
-			world.draw(&ctx, pipeline_layout);
+			world.draw(&ctx, pipeline_layout, cam.get_chunk_position());
 		}
 #endif
 
@@ -946,6 +2086,7 @@ class Game_Scene : public fs::Scene
 {
 public:
 	Game_Scene() {
+		startup_time = fs::timestamp();
 		app_load_data::load(camera_controller);
 		
 		outline_technique.create(engine.graphics);
@@ -954,12 +2095,11 @@ public:
 		rain.create(engine.graphics, outline_technique.render_pass);
 #endif
 
-		last_chunk_position = camera_controller.get_chunk_position();
-
-		world.chunk_offset = last_chunk_position - fs::v3s32(world.render_radius, 0, world.render_radius);
+		world.center_window(camera_controller.get_chunk_position());
 		world.create(engine.graphics);
-		world.generate_all_chunks();
-		world.generate_mesh_for_all_chunks(engine.graphics);
+		world.build_window(); // frames start right away, the window fills in around the camera
+
+		noise_error = noise::max_error_vs_stb();
 	}
 	virtual ~Game_Scene() override {
 #if RAIN
@@ -989,14 +2129,43 @@ public:
 				post_fx_enable = !post_fx_enable;
 			else if (e.key_down.key_id == fs::keys::J)
 				wireframe_depth = !wireframe_depth;
+			else if (e.key_down.key_id == fs::keys::H)
+				world.horizon_culling = !world.horizon_culling;
+			else if (e.key_down.key_id == fs::keys::V)
+				world.cave_culling = !world.cave_culling;
 
 			else if (e.key_down.key_id == fs::keys::Up)
 				_amplitude += 0.1f;
 			else if (e.key_down.key_id == fs::keys::Down)
 				_amplitude -= 0.1f;
 
-			else if (e.key_down.key_id == fs::keys::M)
-				r.upload();
+			else if (e.key_down.key_id == fs::keys::N) {
+				// flip between the vectorized and stb_perlin noise to compare generation time
+				bool scalar = noise::instruction_set.load() == noise::Instruction_Set::Scalar;
+				noise::instruction_set = scalar ? noise::detect_instruction_set() : noise::Instruction_Set::Scalar;
+			}
+			else if (e.key_down.key_id == fs::keys::G) {
+				// cycle through world types, the overlay's generation time compares them
+				auto names = terrain_generator_names();
+				auto it = std::find_if(names.begin(), names.end(), [&](const char* n) { return strcmp(n, world.generator->name()) == 0; });
+				size_t next = (it == names.end()) ? 0 : (size_t(it - names.begin()) + 1) % names.size();
+				world.set_generator(engine.graphics, create_terrain_generator(names[next], world.generator->seed));
+			}
+			else if (e.key_down.key_id == fs::keys::B) {
+				region_benchmark = world.benchmark_region_store();
+				block_type_memory = world.block_type_memory();
+			}
+			else if (e.key_down.key_id == fs::keys::X || e.key_down.key_id == fs::keys::C) {
+				// X digs out the block in the center of the screen, C places one on the face looked at
+				auto origin = World::camera_to_world(camera_controller.position);
+				auto hit = world.raycast({ origin, camera_controller.get_view_direction(), 256.0f });
+				if (hit.hit) {
+					auto v = (e.key_down.key_id == fs::keys::X) ? hit.voxel : hit.voxel + hit.normal;
+					world.set_block(v.x, v.y, v.z, e.key_down.key_id == fs::keys::C);
+				}
+			}
+			else if (e.key_down.key_id == fs::keys::R)
+				raycast_benchmark = world.benchmark_raycast(World::camera_to_world(camera_controller.position));
 		}
 		break; case fs::Event_Key_Up: {
 			if (e.key_down.key_id == fs::keys::Escape)
@@ -1016,16 +2185,25 @@ public:
 
 		static double generation_time = 0.0;
 		auto current_chunk_position = camera_controller.get_chunk_position();
-		if (current_chunk_position.x != last_chunk_position.x ||
-			current_chunk_position.z != last_chunk_position.z) {
-			
+		// edits go out first, the sections they touched may leave the window with this move
+		world.flush_edits();
+		world.update_detail(current_chunk_position);
+		// the window goes where the camera is heading: as soon as the workers have nothing else
+		// to do, or when the camera is about to leave the retained area
+		auto predicted_chunk_position = world.predicted_center(current_chunk_position, camera_controller.velocity);
+		if (world.needs_recenter(current_chunk_position) || (world.needs_recenter(predicted_chunk_position) && world.background_idle())) {
 			auto start = fs::timestamp();
-			last_chunk_position = current_chunk_position;
-			world.recenter_chunks(engine.graphics, last_chunk_position);
+			world.recenter_chunks(engine.graphics, predicted_chunk_position);
 			generation_time = fs::seconds_elasped(start, fs::timestamp());
 		}
+		world.publish_completed_meshes(engine.graphics);
+		Chunk_Mesh::end_frame(engine.graphics);
+		world.update_build_timing();
+		if (time_to_first_frame == 0.0)
+			time_to_first_frame = fs::seconds_elasped(startup_time, fs::timestamp());
 
 		outline_technique.post_fx_enable = post_fx_enable;
+		world.cull(camera_controller.position, current_chunk_position, camera_controller.get_transform());
 		outline_technique.begin(ctx);
 		r.draw(*ctx, camera_controller, world, outline_technique.depth_image.image, wireframe, wireframe_depth);
 #if RAIN
@@ -1034,15 +2212,61 @@ public:
 		outline_technique.end(ctx);
 
 		engine.debug_layer.add("Meshing thread status: %s", (world.info.working? "Active" : "sleep."));
+		engine.debug_layer.add("Column io thread status: %s", (world.io.working? "Active" : "sleep."));
 
 		auto P = glm::ivec3(glm::floor(camera_controller.position));
 		auto C = camera_controller.get_chunk_position();
 		engine.debug_layer.add("Position: %i,%i,%i  Chunk: %i,%i,%i", P.x, P.y, P.z, C.x, C.y, C.z);
+		engine.debug_layer.add("sections loaded: y %i to %i, %i chunks kept past the render radius", world.chunk_offset.y,
+			world.chunk_offset.y + world_chunk_height - 1, world.retention_margin);
 		engine.debug_layer.add("render wireframe: %s", FS_BTF(wireframe));
 		float FOV = camera_controller.field_of_view;
 		engine.debug_layer.add("FOV: %.2f (%.1f deg)", FOV, FOV * (360.0f/float(FS_TAU)));
 		engine.debug_layer.add("number of quads: %i", total_number_of_quads);
+		engine.debug_layer.add("horizon culling: %s, %i of %i columns hidden (%.2f ms)", FS_BTF(world.horizon_culling),
+			world.columns_hidden, world.columns_tested, world.cull_seconds*1e3);
+		engine.debug_layer.add("cave culling: %s, %i sections reachable (%.2f ms)", FS_BTF(world.cave_culling),
+			world.sections_reachable, world.cave_seconds*1e3);
 		engine.debug_layer.add("generation time: %.1f ms", generation_time*1e3);
+		{
+			auto& t = world.build_timing;
+			engine.debug_layer.add("startup: first frame %.0f ms, window build: nearest chunk %.0f ms, all %s%.0f ms", time_to_first_frame*1e3,
+				t.nearest_mesh*1e3, t.finished ? "" : "still loading, ", (t.finished ? t.full_window : fs::seconds_elasped(t.start, fs::timestamp()))*1e3);
+		}
+		if (raycast_benchmark.rays) {
+			auto& b = raycast_benchmark;
+			engine.debug_layer.add("raycast: %.2f M rays/s (%i rays, %.0f%% hit)", double(b.rays) / std::max(b.seconds, 1e-9) * 1e-6,
+				b.rays, 100.0 * double(b.hits) / double(b.rays));
+		}
+		engine.debug_layer.add("edit to visible: %.2f ms (max %.2f ms)", world.last_edit_latency*1e3, world.max_edit_latency*1e3);
+		engine.debug_layer.add("noise: %s (error vs stb_perlin: %g)", noise::instruction_set_name(noise::instruction_set.load()), noise_error);
+		if (region_benchmark.columns) {
+			auto& b = region_benchmark;
+			engine.debug_layer.add("%i columns: load %.1f ms, regenerate %.1f ms (%.0fx)", b.columns,
+				b.load_seconds*1e3, b.generate_seconds*1e3, b.generate_seconds / std::max(b.load_seconds, 1e-9));
+		}
+		if (block_type_memory.sections) {
+			auto& m = block_type_memory;
+			engine.debug_layer.add("voxels: %.1f B/section with types (%.1f MiB, %.0f%% single type)", double(m.bytes) / double(m.sections),
+				double(m.bytes) / double(1024*1024), 100.0 * double(m.uniform_sections) / double(m.sections));
+		}
+		{
+			auto& cache = world.quad_cache;
+			auto hits = cache.hits.load(), misses = cache.misses.load();
+			auto reused_mib = double(cache.quads_reused.load() * 4 * sizeof(vertex)) / double(1024*1024);
+			engine.debug_layer.add("quad cache: %.1f%% of chunks meshed from cache, %.1f MiB of vertices reused",
+				100.0 * double(hits) / double(std::max<int64_t>(hits + misses, 1)), reused_mib);
+			if (auto store = world.mesh_store.get()) {
+				engine.debug_layer.add("mesh store: %.1f%% of cache misses loaded from disk, %.1f MiB on disk, %lli corrupt",
+					100.0 * double(store->hits.load()) / double(std::max<int64_t>(misses, 1)), double(store->size_bytes()) / double(1024*1024),
+					(long long)store->corrupt.load());
+			}
+		}
+		engine.debug_layer.add("terrain: %s (seed %i)", world.generator->name(), world.generator->seed);
+		if (auto cache = world.generator->noise_cache()) {
+			auto hits = cache->tile_hits.load(), misses = cache->tile_misses.load();
+			engine.debug_layer.add("noise cache: %.1f%% hits, %zu tiles", 100.0 * double(hits) / double(std::max<int64_t>(hits + misses, 1)), cache->tile_count());
+		}
 		auto total_mib = double(total_vertex_gpu_memory)/double(1024*1024);
 		auto usage = double(100 * used_vertex_gpu_memory) / double(total_vertex_gpu_memory);
 		engine.debug_layer.add("GPU memory usage: %.2f%% / %.3f MiB", usage, total_mib);
@@ -1061,7 +2285,12 @@ private:
 	bool wireframe = false;
 	bool wireframe_depth = true;
 	bool post_fx_enable  = RAIN? false:true;
-	fs::v3s32 last_chunk_position;
+	float noise_error = 0.0f;
+	decltype(fs::timestamp()) startup_time;
+	double time_to_first_frame = 0.0; // from the scene's constructor to the first frame handed to the renderer
+	World::Region_Benchmark region_benchmark; // filled in by pressing B
+	World::Block_Type_Memory block_type_memory; // same
+	World::Raycast_Benchmark raycast_benchmark; // filled in by pressing R
 
 	Renderer r;
 	Outline_Technique outline_technique;
@@ -1082,19 +2311,54 @@ fs::Defaults on_create() {
 }
 
 int chunk_generation_thread_main(Chunk_Generation_Thread_Info* info) {
-	while (info->active) {
-		std::unique_lock lock(info->mutex);
-		info->cv.wait(lock);
-
-		info->working = true;
-		fs::byte mask[8 * 8];
-		memset(mask, 0xFF, 8 * 8);
-		while (info->work_queue.size()) {
-			auto& work = info->work_queue.back();
+	Mesh_Completion completion;
+	while (true) {
+		Chunk_Generation_Thread_Info::Work work;
+		{
+			std::unique_lock lock(info->mutex);
+			info->working = false;
+			info->idle.notify_all();
+			info->cv.wait(lock, [info] { return !info->active || !info->work_queue.empty(); });
+			if (!info->active) break;
+
+			work = info->work_queue.back();
 			info->work_queue.pop_back();
-			info->world->generate_mesh(engine.graphics, work.x, work.z, *work.mesh, mask);
+			info->working = true;
+		}
+
+		completion.mesh_index = work.mesh_index;
+		completion.ticket = work.ticket;
+		completion.section_ticket = work.section_ticket;
+		completion.edit_serial = work.edit_serial;
+		completion.columns = work.columns;
+		info->world->build_mesh(work.columns, completion.data, work.section);
+
+		// ring is full: the render thread drains it every frame, so just wait our turn. Not while it
+		// waits for us in stop_background_work though, the result is stale by then anyway.
+		while (!info->world->completed_meshes.try_push(std::move(completion))) {
+			if (!info->active) return 0;
+			if (info->cancel) break;
+			std::this_thread::yield();
+		}
+	}
+	return 0;
+}
+
+int column_io_thread_main(Column_IO_Thread_Info* info) {
+	while (true) {
+		Column_IO_Thread_Info::Batch batch;
+		{
+			std::unique_lock lock(info->mutex);
+			info->working = false;
+			info->idle.notify_all();
+			info->cv.wait(lock, [info] { return !info->active || !info->batches.empty(); });
+			if (!info->active) break;
+
+			batch = std::move(info->batches.front());
+			info->batches.pop_front();
+			info->working = true;
 		}
-		info->working = false;
+		info->world->process_io_batch(batch);
 	}
 	return 0;
 }
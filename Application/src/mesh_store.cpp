@@ -0,0 +1,247 @@
+#include "mesh_store.h"
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+	};
+	struct Record {
+		uint64_t hash;
+		uint32_t count;    // quads that follow the key, 4 bytes each
+		uint32_t checksum; // of hash, count, the key and the packed quads
+	};
+	constexpr size_t record_bytes = sizeof(Record) + sizeof(Quad_Cache::Key); // before the quads
+
+	// i0, i1, j0, j1 and slice in 0..8 take 4 bits each, normal_axis in -3..2 takes 3, the block type 8
+	auto pack(quad const& q) -> uint32_t {
+		return uint32_t(q.i0) | uint32_t(q.i1) << 4 | uint32_t(q.j0) << 8 | uint32_t(q.j1) << 12
+			| uint32_t(q.slice) << 16 | uint32_t(q.normal_axis + 3) << 20 | uint32_t(q.type) << 23;
+	}
+	auto unpack(uint32_t w) -> quad {
+		return quad{ char(w & 15), char(w >> 4 & 15), char(w >> 8 & 15), char(w >> 12 & 15),
+			char(w >> 16 & 15), char(int(w >> 20 & 7) - 3), fs::u8(w >> 23) };
+	}
+
+	// FNV-1a over the words, enough to catch torn and garbled records
+	auto checksum(uint64_t hash, Quad_Cache::Key const& key, uint32_t const* words, uint32_t count) -> uint32_t {
+		uint32_t h = 2166136261u;
+		auto add = [&h](uint32_t word) { h = (h ^ word) * 16777619u; };
+		add(uint32_t(hash)); add(uint32_t(hash >> 32)); add(count);
+		auto key_bytes = (uint8_t const*)&key;
+		for (size_t i = 0; i < sizeof(key); i += 4) {
+			uint32_t word;
+			memcpy(&word, key_bytes + i, 4);
+			add(word);
+		}
+		for (uint32_t i = 0; i < count; ++i) add(words[i]);
+		return h;
+	}
+}
+
+struct Mesh_Store::File {
+#if defined(_WIN32)
+	HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+	int fd = -1;
+#endif
+
+	~File() {
+#if defined(_WIN32)
+		if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+#else
+		if (fd >= 0) close(fd);
+#endif
+	}
+
+	auto open(std::filesystem::path const& path) -> bool {
+#if defined(_WIN32)
+		handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		return handle != INVALID_HANDLE_VALUE;
+#else
+		fd = ::open(path.c_str(), O_RDWR);
+		return fd >= 0;
+#endif
+	}
+
+	// Both leave the file position alone, so several threads can read at once.
+	auto read(size_t offset, void* data, size_t bytes) -> bool {
+#if defined(_WIN32)
+		OVERLAPPED at = {};
+		at.Offset     = DWORD(offset);
+		at.OffsetHigh = DWORD(uint64_t(offset) >> 32);
+		DWORD done = 0;
+		return ReadFile(handle, data, DWORD(bytes), &done, &at) && done == bytes;
+#else
+		return pread(fd, data, bytes, off_t(offset)) == ssize_t(bytes);
+#endif
+	}
+	auto write(size_t offset, void const* data, size_t bytes) -> bool {
+#if defined(_WIN32)
+		OVERLAPPED at = {};
+		at.Offset     = DWORD(offset);
+		at.OffsetHigh = DWORD(uint64_t(offset) >> 32);
+		DWORD done = 0;
+		return WriteFile(handle, data, DWORD(bytes), &done, &at) && done == bytes;
+#else
+		return pwrite(fd, data, bytes, off_t(offset)) == ssize_t(bytes);
+#endif
+	}
+	auto truncate(size_t size) -> bool {
+#if defined(_WIN32)
+		FILE_END_OF_FILE_INFO end = {};
+		end.EndOfFile.QuadPart = LONGLONG(size);
+		return SetFileInformationByHandle(handle, FileEndOfFileInfo, &end, sizeof(end));
+#else
+		return ftruncate(fd, off_t(size)) == 0;
+#endif
+	}
+};
+
+Mesh_Store::Mesh_Store(std::filesystem::path path, size_t max_bytes) : max_bytes(max_bytes), path(std::move(path)) {
+	std::error_code ec;
+	std::filesystem::create_directories(this->path.parent_path(), ec);
+	auto size = std::filesystem::file_size(this->path, ec);
+	if (ec || size > max_bytes || !read_index(size))
+		start_over();
+	file = std::make_unique<File>();
+	if (!file->open(this->path)) file.reset();
+}
+
+Mesh_Store::~Mesh_Store() {
+	std::scoped_lock lock{mutex};
+	flush();
+}
+
+auto Mesh_Store::load(Quad_Cache::Key const& key, uint64_t hash, std::vector<quad>& quads) -> bool {
+	Location location;
+	bool buffered;
+	uint32_t started;
+	thread_local std::vector<uint8_t> bytes;
+	{
+		std::scoped_lock lock{mutex};
+		auto it = index.find(hash);
+		if (it == index.end() || !file) return false;
+		location = it->second;
+		started  = generation;
+		bytes.resize(record_bytes + location.count * sizeof(uint32_t));
+		// still in the write buffer, appended records are never moved so it is only copied out here
+		buffered = location.offset >= written;
+		if (buffered) memcpy(bytes.data(), pending.data() + (location.offset - written), bytes.size());
+	}
+	// records in the file are only written again after the file starts over, they are read without
+	// the lock and a read that raced with that fails validation
+	bool read = buffered || file->read(location.offset, bytes.data(), bytes.size());
+
+	Record record;
+	memcpy(&record, bytes.data(), sizeof(record));
+	auto stored_key = (Quad_Cache::Key const*)(bytes.data() + sizeof(Record));
+	auto packed     = (uint32_t const*)(bytes.data() + record_bytes);
+	bool valid = read && record.hash == hash && record.count == location.count
+		&& record.checksum == checksum(hash, *stored_key, packed, location.count);
+	if (!valid || !(*stored_key == key)) {
+		// a garbled record, or another chunk with the same hash: either way the next store replaces it
+		std::scoped_lock lock{mutex};
+		if (generation != started) return false; // the record went away with the old contents
+		auto it = index.find(hash);
+		if (it != index.end() && it->second.offset == location.offset) index.erase(it);
+		if (!valid) corrupt += 1;
+		return false;
+	}
+
+	quads.resize(location.count);
+	for (uint32_t i = 0; i < location.count; ++i) quads[i] = unpack(packed[i]);
+	hits += 1;
+	return true;
+}
+
+auto Mesh_Store::store(Quad_Cache::Key const& key, uint64_t hash, std::vector<quad> const& quads) -> void {
+	std::scoped_lock lock{mutex};
+	auto count = uint32_t(quads.size());
+	size_t bytes = record_bytes + count * sizeof(uint32_t);
+	if (!file || failed || sizeof(Header) + bytes > max_bytes || index.contains(hash)) return;
+	// full: the file starts over, the meshes that are still around get stored again as they are met
+	if (written + pending.size() + bytes > max_bytes) restart();
+	size_t end = written + pending.size();
+
+	size_t at = pending.size();
+	pending.resize(at + bytes);
+	auto packed = (uint32_t*)(pending.data() + at + record_bytes);
+	for (uint32_t i = 0; i < count; ++i) packed[i] = pack(quads[i]);
+	Record record{ hash, count, checksum(hash, key, packed, count) };
+	memcpy(pending.data() + at, &record, sizeof(record));
+	memcpy(pending.data() + at + sizeof(record), &key, sizeof(key));
+
+	index.emplace(hash, Location{ end, count });
+	if (pending.size() >= 1 << 16) flush();
+}
+
+auto Mesh_Store::size_bytes() -> size_t {
+	std::scoped_lock lock{mutex};
+	return written + pending.size();
+}
+
+// Indexes the records of an existing file, false when it is not a store of this version.
+auto Mesh_Store::read_index(size_t size) -> bool {
+	std::ifstream in(path, std::ios::binary);
+	Header header;
+	if (!in.read((char*)&header, sizeof(header)) || header.magic != magic || header.version != version)
+		return false;
+
+	size_t offset = sizeof(Header);
+	Record record;
+	while (offset + record_bytes <= size && in.read((char*)&record, sizeof(record))) {
+		size_t end = offset + record_bytes + size_t(record.count) * sizeof(uint32_t);
+		if (record.count > 8*8*8*6 || end > size) break; // torn by a crash while appending
+		index[record.hash] = Location{ offset, record.count }; // a later record replaces one that failed validation
+		offset = end;
+		in.seekg(std::streamoff(offset));
+	}
+	in.close();
+
+	// later appends go right after the last whole record
+	std::error_code ec;
+	if (offset < size) std::filesystem::resize_file(path, offset, ec);
+	written = offset;
+	return !ec;
+}
+
+auto Mesh_Store::start_over() -> void {
+	index.clear();
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	Header header{ magic, version };
+	out.write((char const*)&header, sizeof(header));
+	written = sizeof(Header);
+	failed  = !out; // nothing gets stored when the file cannot be written
+}
+
+auto Mesh_Store::restart() -> void {
+	index.clear();
+	pending.clear();
+	generation += 1;
+	written = sizeof(Header); // the header stays
+	if (!file->truncate(written)) failed = true;
+}
+
+auto Mesh_Store::flush() -> void {
+	if (pending.empty() || !file || failed) return;
+	if (!file->write(written, pending.data(), pending.size())) {
+		// the records are in the index already, whatever made it to disk is cut off on the next open
+		failed = true;
+		index.clear();
+		pending.clear();
+		return;
+	}
+	written += pending.size();
+	pending.clear();
+}
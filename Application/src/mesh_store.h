@@ -0,0 +1,70 @@
+#pragma once
+#include "mesher.hpp"
+#include "quad_cache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Quads of meshed chunks on disk, by the same content key as Quad_Cache, so chunks meshed in an
+// earlier run or before the window moved away skip generate_quads_for_chunk after a restart.
+//
+// One append-only file: a header, then records of {hash, quad count, checksum, key, packed quads}.
+// Opening reads the record headers into an index by hash, a torn record at the end is cut off.
+// Quads are packed to 4 bytes each. A load checks the record against its checksum and its key
+// against the chunk's: a record that fails the checksum is dropped from the index and meshed
+// again, one of another chunk with the same hash is replaced by the next store. Entries are
+// content-addressed, so an edited chunk keys to a new entry and the old one simply stops being
+// asked for; nothing is overwritten in place. The file is started over when it is opened larger
+// than `max_bytes`, and when an append would take it past that.
+//
+// Safe to call from several threads at once. Records are read with positional reads outside the
+// lock, only the index lookup and appends are serialized.
+struct Mesh_Store {
+	static constexpr uint32_t magic   = 0x4853454D; // "MESH"
+	static constexpr uint32_t version = 2;          // bump when the mesher or chunk_keys change their output, 1 had no keys
+
+	size_t const max_bytes;
+
+	Mesh_Store(std::filesystem::path path, size_t max_bytes);
+	~Mesh_Store();
+
+	Mesh_Store(Mesh_Store const&) = delete;
+
+	// Replaces `quads` with the stored quads of `key`, false when it is not stored or did not validate.
+	// `hash` is key.hash().
+	auto load(Quad_Cache::Key const& key, uint64_t hash, std::vector<quad>& quads) -> bool;
+
+	// Appends the quads of `key` unless they are stored already or the file is full.
+	auto store(Quad_Cache::Key const& key, uint64_t hash, std::vector<quad> const& quads) -> void;
+
+	auto size_bytes() -> size_t;
+
+	// statistics, for the debug overlay
+	std::atomic<int64_t> hits    = 0;
+	std::atomic<int64_t> corrupt = 0; // records that failed validation
+
+private:
+	struct File; // the open file, read and written at explicit offsets
+	struct Location {
+		size_t   offset; // of the record
+		uint32_t count;
+	};
+
+	auto read_index(size_t size) -> bool;
+	auto start_over() -> void;
+	auto restart() -> void; // start_over for the open file, under the lock
+	auto flush() -> void;
+
+	std::filesystem::path const path;
+	std::mutex mutex;
+	std::unique_ptr<File> file;
+	size_t written = 0;            // bytes in the file, appends are buffered in `pending` until flushed
+	uint32_t generation = 0;       // bumped by restart, for loads that read outside the lock
+	bool failed = false;           // a write failed, nothing more is stored
+	std::vector<uint8_t> pending;
+	std::unordered_map<uint64_t, Location> index;
+};
@@ -1,24 +1,29 @@
+#pragma once
 #include <Fission/Base/Math/Vector.hpp>
+#include <cstring>
 #include <vector>
 
 struct quad {
 	char i0, i1, j0, j1;
 	char slice;
 	char normal_axis;
+	fs::u8 type; // block type of every face in the quad
 };
 static constexpr int sizeof_quad = sizeof(quad);
 
-auto scan_quad(fs::u8 m[], int x0, int y0) -> fs::v2s32 {
+// Grows a quad from (x0, y0) over faces with the same key, first along x then along y.
+inline auto scan_quad(fs::u8 m[], int x0, int y0) -> fs::v2s32 {
+	auto key = m[y0 * 8 + x0];
 	int w = 0;
 	for (int x = x0 + 1; x < 8; ++x) {
-		if (!m[y0 * 8 + x]) break;
+		if (m[y0 * 8 + x] != key) break;
 		++w;
 	}
 
 	int h = 0;
 	for (int y = y0 + 1; y < 8; ++y) {
 		for (int x = x0; x <= x0 + w; ++x) {
-			if (!m[y * 8 + x]) goto done;
+			if (m[y * 8 + x] != key) goto done;
 		}
 		++h;
 	}
@@ -26,7 +31,9 @@ auto scan_quad(fs::u8 m[], int x0, int y0) -> fs::v2s32 {
 	return {x0 + w, y0 + h};
 };
 		
-auto generate_quads_for_slice(fs::u8 mask[], int slice, int normal_axis, std::vector<quad>& quads) -> void {
+// `mask` holds one key per face: 0 for no face, otherwise the block type + 1.
+// Only faces with the same key are merged.
+inline auto generate_quads_for_slice(fs::u8 mask[], int slice, int normal_axis, std::vector<quad>& quads) -> void {
 	for (int y0 = 0; y0 < 8; ++y0)
 	for (int x0 = 0; x0 < 8; ) {
 		if (!mask[y0 * 8 + x0]) {
@@ -36,7 +43,7 @@ auto generate_quads_for_slice(fs::u8 mask[], int slice, int normal_axis, std::ve
 
 		auto [x1, y1] = scan_quad(mask, x0, y0);
 
-		quads.emplace_back(x0, x1 + 1, y0, y1 + 1, slice, normal_axis);
+		quads.emplace_back(x0, x1 + 1, y0, y1 + 1, slice, normal_axis, fs::u8(mask[y0 * 8 + x0] - 1));
 
 		for (int x = x0; x <= x1; ++x)
 		for (int y = y0; y <= y1; ++y) {
@@ -54,7 +61,56 @@ struct adjacent_chunks {
 	fs::u8* neg[3];
 };
 
-auto generate_quads_for_chunk(fs::u8* chunk_mask, adjacent_chunks const* adjacent, std::vector<quad>& quads) -> void {
+// Merge key of every voxel of a chunk, index y*64 + z*8 + x: 0 for air, otherwise block type + 1.
+// `types` is the block type of every voxel, only read where the mask is set.
+inline auto chunk_keys(fs::u8 const* chunk_mask, fs::u8 const* types, fs::u8 keys[8*8*8]) -> void {
+	for (int v = 0; v < 8*8*8; ++v)
+		keys[v] = ((chunk_mask[v >> 3] >> (v & 7)) & 1) ? fs::u8(types[v] + 1) : 0;
+}
+
+// Distant chunks are meshed coarser: every f*f*f cell (f = 2, 4 or 8) is solid where any voxel in it
+// is, kept at full size so the mesher and the vertex layout stay the same.
+inline auto downsample_mask(fs::u8 const* chunk_mask, int f, fs::u8 out[8*8]) -> void {
+	auto group = fs::u8((1 << f) - 1);
+	for (int y0 = 0; y0 < 8; y0 += f)
+	for (int z0 = 0; z0 < 8; z0 += f) {
+		fs::u8 any = 0;
+		for (int y = y0; y < y0 + f; ++y)
+		for (int z = z0; z < z0 + f; ++z)
+			any |= chunk_mask[y*8 + z];
+		fs::u8 bits = 0;
+		for (int x0 = 0; x0 < 8; x0 += f)
+			if ((any >> x0) & group) bits |= fs::u8(group << x0);
+		for (int y = y0; y < y0 + f; ++y)
+		for (int z = z0; z < z0 + f; ++z)
+			out[y*8 + z] = bits;
+	}
+}
+
+// Merge keys to go with downsample_mask, every cell takes the block type of its highest solid voxel
+// so the ground keeps its surface color from afar.
+inline auto downsample_keys(fs::u8 const* chunk_mask, fs::u8 const* types, int f, fs::u8 keys[8*8*8]) -> void {
+	for (int y0 = 0; y0 < 8; y0 += f)
+	for (int z0 = 0; z0 < 8; z0 += f)
+	for (int x0 = 0; x0 < 8; x0 += f) {
+		fs::u8 key = 0;
+		for (int y = y0 + f - 1; y >= y0 && !key; --y)
+		for (int z = z0; z < z0 + f && !key; ++z)
+		for (int x = x0; x < x0 + f; ++x)
+			if ((chunk_mask[y*8 + z] >> x) & 1) {
+				key = fs::u8(types[y*64 + z*8 + x] + 1);
+				break;
+			}
+		for (int y = y0; y < y0 + f; ++y)
+		for (int z = z0; z < z0 + f; ++z)
+			memset(keys + y*64 + z*8 + x0, key, size_t(f));
+	}
+}
+
+// `keys` comes from chunk_keys. The quads only depend on the keys and on the faces of the adjacent
+// chunks that touch this one, they are in chunk-local coordinates.
+// A `full` chunk (every voxel solid) can only have faces on its six boundary planes, the inner slices are skipped.
+inline auto generate_quads_for_chunk(fs::u8 const* chunk_mask, fs::u8 const* keys, adjacent_chunks const* adjacent, std::vector<quad>& quads, bool full = false) -> void {
 	union vec3 {
 		char comp[4];
 		struct {
@@ -68,7 +124,7 @@ auto generate_quads_for_chunk(fs::u8* chunk_mask, adjacent_chunks const* adjacen
 		int i_axis = (normal_axis+1)%3;
 		int j_axis = (normal_axis+2)%3;
 		auto adjacent_chunk_mask = adjacent->pos[normal_axis];
-		for_n(slice, (char)8) {
+		for (char slice = 0; slice < (full ? 1 : 8); ++slice) {
 			// generate mask
 			vec3 pos;
 			for_n (i, (char)8)
@@ -76,7 +132,7 @@ auto generate_quads_for_chunk(fs::u8* chunk_mask, adjacent_chunks const* adjacen
 				pos.comp[normal_axis] = slice;
 				pos.comp[i_axis] = i;
 				pos.comp[j_axis] = j;
-				mask[j*8 + i] = chunk_mask[pos.y*8 + pos.z] & (1 << pos.x);
+				mask[j*8 + i] = keys[pos.y*64 + pos.z*8 + pos.x];
 				int next = slice - 1;
 				if (next >= 0) {
 					pos.comp[normal_axis] = next;
@@ -98,7 +154,7 @@ auto generate_quads_for_chunk(fs::u8* chunk_mask, adjacent_chunks const* adjacen
 		int i_axis = (normal_axis+1)%3;
 		int j_axis = (normal_axis+2)%3;
 		auto adjacent_chunk_mask = adjacent->neg[normal_axis];
-		for_n(slice, (char)8) {
+		for (char slice = (full ? 7 : 0); slice < 8; ++slice) {
 			// generate mask
 			vec3 pos;
 			for_n (i, (char)8)
@@ -106,7 +162,7 @@ auto generate_quads_for_chunk(fs::u8* chunk_mask, adjacent_chunks const* adjacen
 				pos.comp[normal_axis] = slice;
 				pos.comp[i_axis] = i;
 				pos.comp[j_axis] = j;
-				mask[j*8 + i] = chunk_mask[pos.y*8 + pos.z] & (1 << pos.x);
+				mask[j*8 + i] = keys[pos.y*64 + pos.z*8 + pos.x];
 				int next = slice + 1;
 				if (next < 8) {
 					pos.comp[normal_axis] = next;
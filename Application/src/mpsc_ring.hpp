@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Bounded lock-free multi-producer/single-consumer ring.
+// Producers claim a cell by bumping `tail`; the consumer is the only one that touches `head`.
+// Every cell carries a sequence number, so the consumer can tell a claimed-but-unwritten
+// cell from a published one and never has to wait on a producer.
+template <typename T, size_t Capacity>
+struct Mpsc_Ring {
+	static_assert((Capacity & (Capacity - 1)) == 0, "Mpsc_Ring capacity must be a power of two");
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	Mpsc_Ring() {
+		for (size_t i = 0; i < Capacity; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	Mpsc_Ring(Mpsc_Ring const&) = delete;
+
+	// Called from any thread. Returns false when the ring is full, `value` is left untouched.
+	auto try_push(T&& value) -> bool {
+		size_t pos = tail.load(std::memory_order_relaxed);
+		for (;;) {
+			auto& cell = cells[pos & (Capacity - 1)];
+			auto seq = cell.sequence.load(std::memory_order_acquire);
+			auto diff = intptr_t(seq) - intptr_t(pos);
+			if (diff == 0) {
+				if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.value = std::move(value);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Only ever called from the consumer thread.
+	auto try_pop(T& out) -> bool {
+		auto& cell = cells[head & (Capacity - 1)];
+		auto seq = cell.sequence.load(std::memory_order_acquire);
+		if (intptr_t(seq) - intptr_t(head + 1) < 0)
+			return false;
+		out = std::move(cell.value);
+		cell.sequence.store(head + Capacity, std::memory_order_release);
+		++head;
+		return true;
+	}
+
+	alignas(64) Cell                cells[Capacity];
+	alignas(64) std::atomic<size_t> tail = 0;
+	alignas(64) size_t              head = 0;
+};
@@ -0,0 +1,316 @@
+#include "noise.h"
+#define STB_PERLIN_IMPLEMENTATION 1
+#include <stb_perlin.h>
+#include <immintrin.h>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define NOISE_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define NOISE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace noise {
+	std::atomic<Instruction_Set> instruction_set = detect_instruction_set();
+
+	auto detect_instruction_set() -> Instruction_Set {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return Instruction_Set::Scalar;
+
+		__cpuid(info, 1);
+		bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+
+		__cpuidex(info, 7, 0);
+		bool has_avx2 = info[1] & (1 << 5);
+
+		return (os_saves_ymm && has_avx2) ? Instruction_Set::AVX2 : Instruction_Set::Scalar;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? Instruction_Set::AVX2 : Instruction_Set::Scalar;
+#endif
+	}
+
+	auto instruction_set_name(Instruction_Set set) -> const char* {
+		switch (set)
+		{
+		case Instruction_Set::AVX2: return "AVX2";
+		default:                    return "scalar";
+		}
+	}
+
+	// stb_perlin stores both hash tables twice, so `table[h + 1]` is always the entry for the
+	// next lattice coordinate, even where it wraps from 255 back to 0. A 32-bit gather at byte
+	// offset `h` therefore fetches both neighbors at once; the padding keeps that read in bounds.
+	struct Tables {
+		alignas(32) unsigned char randtab[512 + 4];
+		alignas(32) unsigned char grad_idx[512 + 4];
+
+		Tables() {
+			memset(randtab, 0, sizeof(randtab));
+			memset(grad_idx, 0, sizeof(grad_idx));
+			memcpy(randtab, stb__perlin_randtab, 512);
+			memcpy(grad_idx, stb__perlin_randtab_grad_idx, 512);
+		}
+	};
+	static Tables const tables;
+
+	NOISE_TARGET_AVX2 static inline auto fastfloor_avx2(__m256 a) -> __m256i {
+		auto ai = _mm256_cvttps_epi32(a);
+		auto lt = _mm256_cmp_ps(a, _mm256_cvtepi32_ps(ai), _CMP_LT_OQ);
+		return _mm256_add_epi32(ai, _mm256_castps_si256(lt)); // lt is all ones (-1) where a < ai
+	}
+
+	NOISE_TARGET_AVX2 static inline auto ease_avx2(__m256 a) -> __m256 {
+		// (((a*6-15)*a + 10) * a * a * a), same evaluation order as stb__perlin_ease
+		auto r = _mm256_sub_ps(_mm256_mul_ps(a, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+		r = _mm256_add_ps(_mm256_mul_ps(r, a), _mm256_set1_ps(10.0f));
+		r = _mm256_mul_ps(r, a);
+		r = _mm256_mul_ps(r, a);
+		return _mm256_mul_ps(r, a);
+	}
+
+	NOISE_TARGET_AVX2 static inline auto lerp_avx2(__m256 a, __m256 b, __m256 t) -> __m256 {
+		return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+	}
+
+	struct Lookup_Pair {
+		__m256i first;
+		__m256i second;
+	};
+
+	// Returns (table[h], table[h + 1]) per lane.
+	NOISE_TARGET_AVX2 static inline auto lookup_pair_avx2(unsigned char const* table, __m256i h) -> Lookup_Pair {
+		auto const byte = _mm256_set1_epi32(0xFF);
+		auto bytes = _mm256_i32gather_epi32((int const*)table, h, 1);
+		return { _mm256_and_si256(bytes, byte), _mm256_and_si256(_mm256_srli_epi32(bytes, 8), byte) };
+	}
+
+	NOISE_TARGET_AVX2 static inline auto same_in_all_lanes_avx2(__m256i x, __m256i y, __m256i z) -> bool {
+		auto const first = _mm256_setzero_si256();
+		auto diff = _mm256_or_si256(
+			_mm256_xor_si256(x, _mm256_permutevar8x32_epi32(x, first)),
+			_mm256_or_si256(
+				_mm256_xor_si256(y, _mm256_permutevar8x32_epi32(y, first)),
+				_mm256_xor_si256(z, _mm256_permutevar8x32_epi32(z, first))));
+		return _mm256_testz_si256(diff, diff);
+	}
+
+	// stb__perlin_grad without the table: gradients 0-3 are (+-x +-y), 4-7 are (+-x +-z) and 8-11 are (+-y +-z),
+	// with bit 0 flipping the first term and bit 1 the second. Multiplying by 1, -1 or 0 is exact, so this
+	// gives the same value as the basis table (at most the sign of an exact zero differs).
+	NOISE_TARGET_AVX2 static inline auto grad_avx2(__m256i idx, __m256 x, __m256 y, __m256 z) -> __m256 {
+		auto uses_y = _mm256_castsi256_ps(_mm256_cmpgt_epi32(idx, _mm256_set1_epi32(7)));
+		auto uses_z = _mm256_castsi256_ps(_mm256_cmpgt_epi32(idx, _mm256_set1_epi32(3)));
+		auto a = _mm256_blendv_ps(x, y, uses_y);
+		auto b = _mm256_blendv_ps(y, z, uses_z);
+		auto a_sign = _mm256_castsi256_ps(_mm256_slli_epi32(idx, 31));
+		auto b_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(idx, 1), 31));
+		return _mm256_add_ps(_mm256_xor_ps(a, a_sign), _mm256_xor_ps(b, b_sign));
+	}
+
+	// stb_perlin_noise3_internal with no wrapping, 8 lanes at a time
+	NOISE_TARGET_AVX2 static inline auto perlin_noise3_avx2(__m256 x, __m256 y, __m256 z, int seed) -> __m256 {
+		auto const mask = _mm256_set1_epi32(255);
+		auto const one = _mm256_set1_ps(1.0f);
+
+		auto px = fastfloor_avx2(x);
+		auto py = fastfloor_avx2(y);
+		auto pz = fastfloor_avx2(z);
+		auto x0 = _mm256_and_si256(px, mask);
+		auto y0 = _mm256_and_si256(py, mask);
+		auto z0 = _mm256_and_si256(pz, mask);
+
+		x = _mm256_sub_ps(x, _mm256_cvtepi32_ps(px)); auto u = ease_avx2(x);
+		y = _mm256_sub_ps(y, _mm256_cvtepi32_ps(py)); auto v = ease_avx2(y);
+		z = _mm256_sub_ps(z, _mm256_cvtepi32_ps(pz)); auto w = ease_avx2(z);
+
+		Lookup_Pair g00, g01, g10, g11;
+		if (same_in_all_lanes_avx2(x0, y0, z0)) {
+			// Common case for heightfields: neighboring samples share a lattice cell, hash it once.
+			int cx = _mm256_cvtsi256_si32(x0), cy = _mm256_cvtsi256_si32(y0), cz = _mm256_cvtsi256_si32(z0);
+			int r0  = tables.randtab[cx + seed], r1 = tables.randtab[cx + seed + 1];
+			int r00 = tables.randtab[r0 + cy], r01 = tables.randtab[r0 + cy + 1];
+			int r10 = tables.randtab[r1 + cy], r11 = tables.randtab[r1 + cy + 1];
+			g00 = { _mm256_set1_epi32(tables.grad_idx[r00 + cz]), _mm256_set1_epi32(tables.grad_idx[r00 + cz + 1]) };
+			g01 = { _mm256_set1_epi32(tables.grad_idx[r01 + cz]), _mm256_set1_epi32(tables.grad_idx[r01 + cz + 1]) };
+			g10 = { _mm256_set1_epi32(tables.grad_idx[r10 + cz]), _mm256_set1_epi32(tables.grad_idx[r10 + cz + 1]) };
+			g11 = { _mm256_set1_epi32(tables.grad_idx[r11 + cz]), _mm256_set1_epi32(tables.grad_idx[r11 + cz + 1]) };
+		}
+		else {
+			auto [r0, r1] = lookup_pair_avx2(tables.randtab, _mm256_add_epi32(x0, _mm256_set1_epi32(seed)));
+
+			auto [r00, r01] = lookup_pair_avx2(tables.randtab, _mm256_add_epi32(r0, y0));
+			auto [r10, r11] = lookup_pair_avx2(tables.randtab, _mm256_add_epi32(r1, y0));
+
+			g00 = lookup_pair_avx2(tables.grad_idx, _mm256_add_epi32(r00, z0));
+			g01 = lookup_pair_avx2(tables.grad_idx, _mm256_add_epi32(r01, z0));
+			g10 = lookup_pair_avx2(tables.grad_idx, _mm256_add_epi32(r10, z0));
+			g11 = lookup_pair_avx2(tables.grad_idx, _mm256_add_epi32(r11, z0));
+		}
+
+		auto xm = _mm256_sub_ps(x, one);
+		auto ym = _mm256_sub_ps(y, one);
+		auto zm = _mm256_sub_ps(z, one);
+
+		auto n000 = grad_avx2(g00.first , x , y , z );
+		auto n001 = grad_avx2(g00.second, x , y , zm);
+		auto n010 = grad_avx2(g01.first , x , ym, z );
+		auto n011 = grad_avx2(g01.second, x , ym, zm);
+		auto n100 = grad_avx2(g10.first , xm, y , z );
+		auto n101 = grad_avx2(g10.second, xm, y , zm);
+		auto n110 = grad_avx2(g11.first , xm, ym, z );
+		auto n111 = grad_avx2(g11.second, xm, ym, zm);
+
+		auto n00 = lerp_avx2(n000, n001, w);
+		auto n01 = lerp_avx2(n010, n011, w);
+		auto n10 = lerp_avx2(n100, n101, w);
+		auto n11 = lerp_avx2(n110, n111, w);
+
+		auto n0 = lerp_avx2(n00, n01, v);
+		auto n1 = lerp_avx2(n10, n11, v);
+
+		return lerp_avx2(n0, n1, u);
+	}
+
+	NOISE_TARGET_AVX2 static auto noise3_avx2(float const* x, float const* y, float const* z, int count, int seed, float* out) -> int {
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto r = perlin_noise3_avx2(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i), seed);
+			_mm256_storeu_ps(out + i, r);
+		}
+		return i;
+	}
+
+	NOISE_TARGET_AVX2 static auto ridge_noise3_avx2(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, float offset, int octaves, float* out) -> int
+	{
+		auto const sign_mask = _mm256_set1_ps(-0.0f);
+		auto const offset_v = _mm256_set1_ps(offset);
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto px = _mm256_loadu_ps(x + i);
+			auto py = _mm256_loadu_ps(y + i);
+			auto pz = _mm256_loadu_ps(z + i);
+
+			float frequency = 1.0f;
+			float amplitude = 0.5f;
+			auto prev = _mm256_set1_ps(1.0f);
+			auto sum = _mm256_setzero_ps();
+
+			for (int o = 0; o < octaves; ++o) {
+				auto f = _mm256_set1_ps(frequency);
+				auto r = perlin_noise3_avx2(_mm256_mul_ps(px, f), _mm256_mul_ps(py, f), _mm256_mul_ps(pz, f), (unsigned char)o);
+				r = _mm256_sub_ps(offset_v, _mm256_andnot_ps(sign_mask, r));
+				r = _mm256_mul_ps(r, r);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_mul_ps(r, _mm256_set1_ps(amplitude)), prev));
+				prev = r;
+				frequency *= lacunarity;
+				amplitude *= gain;
+			}
+			_mm256_storeu_ps(out + i, sum);
+		}
+		return i;
+	}
+
+	NOISE_TARGET_AVX2 static auto fbm_noise3_avx2(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, int octaves, float* out) -> int
+	{
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto px = _mm256_loadu_ps(x + i);
+			auto py = _mm256_loadu_ps(y + i);
+			auto pz = _mm256_loadu_ps(z + i);
+
+			float frequency = 1.0f;
+			float amplitude = 1.0f;
+			auto sum = _mm256_setzero_ps();
+
+			for (int o = 0; o < octaves; ++o) {
+				auto f = _mm256_set1_ps(frequency);
+				auto r = perlin_noise3_avx2(_mm256_mul_ps(px, f), _mm256_mul_ps(py, f), _mm256_mul_ps(pz, f), (unsigned char)o);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(r, _mm256_set1_ps(amplitude)));
+				frequency *= lacunarity;
+				amplitude *= gain;
+			}
+			_mm256_storeu_ps(out + i, sum);
+		}
+		return i;
+	}
+
+	auto noise3(float const* x, float const* y, float const* z, int count, float* out) -> void {
+		int i = 0;
+		if (instruction_set.load(std::memory_order_relaxed) == Instruction_Set::AVX2)
+			i = noise3_avx2(x, y, z, count, 0, out);
+		for (; i < count; ++i)
+			out[i] = stb_perlin_noise3(x[i], y[i], z[i], 0, 0, 0);
+	}
+
+	auto noise3_seed(float const* x, float const* y, float const* z, int count, int seed, float* out) -> void {
+		int i = 0;
+		if (instruction_set.load(std::memory_order_relaxed) == Instruction_Set::AVX2)
+			i = noise3_avx2(x, y, z, count, (unsigned char)seed, out);
+		for (; i < count; ++i)
+			out[i] = stb_perlin_noise3_seed(x[i], y[i], z[i], 0, 0, 0, seed);
+	}
+
+	auto ridge_noise3(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, float offset, int octaves, float* out) -> void
+	{
+		int i = 0;
+		if (instruction_set.load(std::memory_order_relaxed) == Instruction_Set::AVX2)
+			i = ridge_noise3_avx2(x, y, z, count, lacunarity, gain, offset, octaves, out);
+		for (; i < count; ++i)
+			out[i] = stb_perlin_ridge_noise3(x[i], y[i], z[i], lacunarity, gain, offset, octaves);
+	}
+
+	auto fbm_noise3(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, int octaves, float* out) -> void
+	{
+		int i = 0;
+		if (instruction_set.load(std::memory_order_relaxed) == Instruction_Set::AVX2)
+			i = fbm_noise3_avx2(x, y, z, count, lacunarity, gain, octaves, out);
+		for (; i < count; ++i)
+			out[i] = stb_perlin_fbm_noise3(x[i], y[i], z[i], lacunarity, gain, octaves);
+	}
+
+	auto max_error_vs_stb() -> float {
+		static constexpr int count = 1024;
+		float x[count], y[count], z[count];
+		float batched[count];
+
+		// spread over positive and negative coordinates, including exact lattice points
+		for (int i = 0; i < count; ++i) {
+			x[i] = float(i % 64 - 32) * 0.37f + float(i) / 256.0f;
+			y[i] = float(i / 64 - 8) * 1.13f;
+			z[i] = (i & 1) ? 0.225f : float(i % 7) - 3.0f;
+		}
+
+		float error = 0.0f;
+
+		noise3(x, y, z, count, batched);
+		for (int i = 0; i < count; ++i)
+			error = std::max(error, std::fabs(batched[i] - stb_perlin_noise3(x[i], y[i], z[i], 0, 0, 0)));
+
+		noise3_seed(x, y, z, count, 3, batched);
+		for (int i = 0; i < count; ++i)
+			error = std::max(error, std::fabs(batched[i] - stb_perlin_noise3_seed(x[i], y[i], z[i], 0, 0, 0, 3)));
+
+		ridge_noise3(x, y, z, count, 2.0f, 0.5f, 1.0f, 6, batched);
+		for (int i = 0; i < count; ++i)
+			error = std::max(error, std::fabs(batched[i] - stb_perlin_ridge_noise3(x[i], y[i], z[i], 2.0f, 0.5f, 1.0f, 6)));
+
+		fbm_noise3(x, y, z, count, 2.0f, 0.5f, 8, batched);
+		for (int i = 0; i < count; ++i)
+			error = std::max(error, std::fabs(batched[i] - stb_perlin_fbm_noise3(x[i], y[i], z[i], 2.0f, 0.5f, 8)));
+
+		return error;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+
+// Batched versions of the stb_perlin functions used by terrain generation.
+// Every function evaluates `count` independent sample points and writes one result per point.
+// The AVX2 path does the exact same float operations in the same order as stb_perlin,
+// so results are bit-identical to calling stb_perlin in a loop (see `noise::max_error_vs_stb`).
+namespace noise {
+	enum class Instruction_Set {
+		Scalar, // plain loop over stb_perlin
+		AVX2,   // 8 samples per step
+	};
+
+	// Picked once at startup from cpuid, can be overridden for benchmarking while columns are being
+	// generated; every call reads it once, and both paths give the same results.
+	extern std::atomic<Instruction_Set> instruction_set;
+
+	auto detect_instruction_set() -> Instruction_Set;
+	auto instruction_set_name(Instruction_Set set) -> const char*;
+
+	// Same as stb_perlin_noise3(x, y, z, 0, 0, 0) for each point.
+	auto noise3(float const* x, float const* y, float const* z, int count, float* out) -> void;
+
+	// Same as stb_perlin_noise3_seed(x, y, z, 0, 0, 0, seed) for each point,
+	// this is the single octave `seed` that ridge and fbm noise sum up.
+	auto noise3_seed(float const* x, float const* y, float const* z, int count, int seed, float* out) -> void;
+
+	// Same as stb_perlin_ridge_noise3 for each point.
+	auto ridge_noise3(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, float offset, int octaves, float* out) -> void;
+
+	// Same as stb_perlin_fbm_noise3 for each point.
+	auto fbm_noise3(float const* x, float const* y, float const* z, int count,
+		float lacunarity, float gain, int octaves, float* out) -> void;
+
+	// Evaluates a fixed set of points with both the current instruction set and stb_perlin,
+	// returns the largest absolute difference (0 when bit-identical).
+	auto max_error_vs_stb() -> float;
+}
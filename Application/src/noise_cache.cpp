@@ -0,0 +1,155 @@
+#include "noise_cache.h"
+#include "noise.h"
+#include <algorithm>
+#include <cmath>
+
+Noise_Cache::Noise_Cache(Ridge_Params const& params, int samples_per_cell, size_t max_tiles)
+	: params(params), samples_per_cell(samples_per_cell), max_tiles(max_tiles)
+{
+	// keep `samples_per_cell` samples across one lattice cell of each octave,
+	// rounded to a power of two so a tile always covers whole 8x8 columns
+	float frequency = 1.0f;
+	for (int octave = 0; octave < params.octaves; ++octave) {
+		float cell = 1.0f / (params.scale * frequency); // in voxels
+		int shift = 0;
+		while (shift < 8 && float((2 << shift) * samples_per_cell) <= cell) ++shift;
+		spacing_shift.push_back(shift);
+		frequency *= params.lacunarity;
+	}
+}
+
+auto Noise_Cache::height_field(int x0, int z0, float out[64]) -> void {
+	float x[64], z[64], y[64];
+	for (int j = 0; j < 8; ++j)
+	for (int i = 0; i < 8; ++i) {
+		x[j*8 + i] = float(x0 + i) * params.scale;
+		z[j*8 + i] = float(z0 + j) * params.scale;
+		y[j*8 + i] = params.y;
+	}
+
+	float sum[64], prev[64], n[64];
+	std::fill_n(sum, 64, 0.0f);
+	std::fill_n(prev, 64, 1.0f);
+
+	float frequency = 1.0f;
+	float amplitude = 0.5f;
+	for (int octave = 0; octave < params.octaves; ++octave) {
+		int shift = spacing_shift[octave];
+		if (shift == 0) {
+			float fx[64], fz[64], fy[64];
+			for (int i = 0; i < 64; ++i) {
+				fx[i] = x[i] * frequency;
+				fz[i] = z[i] * frequency;
+				fy[i] = y[i] * frequency;
+			}
+			noise::noise3_seed(fx, fz, fy, 64, octave, n);
+		}
+		else {
+			// a tile spans a multiple of 8 voxels, so the whole column lands in one tile
+			int span = tile_samples << shift;
+			int tile_x = x0 >> (tile_shift + shift); // floor division
+			int tile_z = z0 >> (tile_shift + shift);
+			auto tile = get_tile(octave, tile_x, tile_z);
+
+			// the column touches 8/spacing+1 sample rows (2 when spacing > 8), lerp each of
+			// those along x once, then every voxel row is a lerp of two of them along z
+			int mask = (1 << shift) - 1;
+			float inv_spacing = 1.0f / float(1 << shift);
+			int lx0 = x0 - tile_x * span;
+			int lz0 = z0 - tile_z * span;
+			int sz0 = lz0 >> shift;
+			int row_count = std::max(8 >> shift, 1) + 1;
+
+			float rows[9][8];
+			for (int r = 0; r < row_count; ++r) {
+				float const* samples = tile->samples + (sz0 + r) * (tile_samples + 1);
+				for (int i = 0; i < 8; ++i) {
+					int lx = lx0 + i;
+					float tx = float(lx & mask) * inv_spacing;
+					float a = samples[lx >> shift];
+					float b = samples[(lx >> shift) + 1];
+					rows[r][i] = a + (b - a) * tx;
+				}
+			}
+			for (int j = 0; j < 8; ++j) {
+				int lz = lz0 + j;
+				float tz = float(lz & mask) * inv_spacing;
+				float const* a = rows[(lz >> shift) - sz0];
+				float const* b = a + 8;
+				for (int i = 0; i < 8; ++i)
+					n[j*8 + i] = a[i] + (b[i] - a[i]) * tz;
+			}
+		}
+
+		// same accumulation as stb_perlin_ridge_noise3
+		for (int i = 0; i < 64; ++i) {
+			float r = params.offset - std::fabs(n[i]);
+			r = r*r;
+			sum[i] += r*amplitude*prev[i];
+			prev[i] = r;
+		}
+		frequency *= params.lacunarity;
+		amplitude *= params.gain;
+	}
+
+	std::copy_n(sum, 64, out);
+}
+
+auto Noise_Cache::get_tile(int octave, int tile_x, int tile_z) -> std::shared_ptr<Tile const> {
+	Key key = (Key(octave & 0xFF) << 56) | (Key(tile_x & 0x0FFFFFFF) << 28) | Key(tile_z & 0x0FFFFFFF);
+	{
+		std::scoped_lock lock{mutex};
+		if (auto it = tiles.find(key); it != tiles.end()) {
+			lru.splice(lru.begin(), lru, it->second.position);
+			++tile_hits;
+			return it->second.tile;
+		}
+		++tile_misses;
+	}
+
+	// built outside the lock, two threads missing on the same tile just do the work twice
+	auto tile = std::make_shared<Tile>();
+	build_tile(octave, tile_x, tile_z, *tile);
+
+	std::scoped_lock lock{mutex};
+	if (auto it = tiles.find(key); it != tiles.end())
+		return it->second.tile;
+
+	lru.push_front(key);
+	tiles.emplace(key, Entry{ tile, lru.begin() });
+	while (tiles.size() > max_tiles) {
+		tiles.erase(lru.back());
+		lru.pop_back();
+	}
+	return tile;
+}
+
+auto Noise_Cache::build_tile(int octave, int tile_x, int tile_z, Tile& tile) -> void {
+	static constexpr int count = (tile_samples + 1) * (tile_samples + 1);
+	int spacing = sample_spacing(octave);
+	int span = tile_samples * spacing;
+	float frequency = 1.0f; // accumulated the same way as the octave loop in height_field
+	for (int i = 0; i < octave; ++i) frequency *= params.lacunarity;
+
+	float x[count], z[count], y[count];
+	for (int j = 0; j <= tile_samples; ++j)
+	for (int i = 0; i <= tile_samples; ++i) {
+		int n = j * (tile_samples + 1) + i;
+		x[n] = float(tile_x * span + i * spacing) * params.scale * frequency;
+		z[n] = float(tile_z * span + j * spacing) * params.scale * frequency;
+		y[n] = params.y * frequency;
+	}
+	noise::noise3_seed(x, z, y, count, octave, tile.samples);
+}
+
+auto Noise_Cache::clear() -> void {
+	std::scoped_lock lock{mutex};
+	tiles.clear();
+	lru.clear();
+	tile_hits = tile_misses = 0;
+}
+
+auto Noise_Cache::tile_count() -> size_t {
+	std::scoped_lock lock{mutex};
+	return tiles.size();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Parameters of the stb_perlin_ridge_noise3 heightfield, evaluated at
+// (x * scale, z * scale, y) for voxel location (x, z).
+struct Ridge_Params {
+	float scale      = 1.0f / 256.0f;
+	float y          = 0.225f;
+	float lacunarity = 2.0f;
+	float gain       = 0.5f;
+	float offset     = 1.0f;
+	int   octaves    = 6;
+};
+
+// Ridge noise heightfields with the low frequency octaves shared between columns.
+//
+// An octave whose lattice cell spans many voxels is smooth at voxel scale, so it is sampled on a
+// coarser grid (`samples_per_cell` samples across one lattice cell) and bilinearly upsampled.
+// Those grids are stored in tiles that cover many columns and are kept in an LRU list, so
+// neighboring columns and revisited areas reuse them. Octaves that need per-voxel resolution
+// are evaluated directly, exactly like stb_perlin.
+//
+// Safe to call from several threads at once.
+struct Noise_Cache {
+	static constexpr int tile_shift   = 5;
+	static constexpr int tile_samples = 1 << tile_shift; // samples per tile side (plus one border sample)
+
+	struct Tile {
+		float samples[(tile_samples + 1) * (tile_samples + 1)];
+	};
+
+	Ridge_Params const params;
+	int const          samples_per_cell;
+	size_t const       max_tiles;
+
+	Noise_Cache(Ridge_Params const& params = {}, int samples_per_cell = 16, size_t max_tiles = 2048);
+
+	// Heights for the 8x8 locations starting at (x0, z0), `x0` and `z0` multiples of 8.
+	auto height_field(int x0, int z0, float out[64]) -> void;
+
+	// Voxels between grid samples for `octave` (a power of two), 1 means the octave is evaluated per voxel.
+	auto sample_spacing(int octave) const -> int { return 1 << spacing_shift[octave]; }
+
+	auto clear() -> void;
+
+	// statistics, for the debug overlay
+	std::atomic<int64_t> tile_hits   = 0;
+	std::atomic<int64_t> tile_misses = 0;
+	auto tile_count() -> size_t;
+
+private:
+	using Key = uint64_t;
+
+	auto get_tile(int octave, int tile_x, int tile_z) -> std::shared_ptr<Tile const>;
+	auto build_tile(int octave, int tile_x, int tile_z, Tile& tile) -> void;
+
+	std::vector<int> spacing_shift; // log2 of the sample spacing, per octave
+
+	std::mutex mutex;
+	std::list<Key> lru; // front is most recently used
+	struct Entry {
+		std::shared_ptr<Tile const> tile;
+		std::list<Key>::iterator    position;
+	};
+	std::unordered_map<Key, Entry> tiles;
+};
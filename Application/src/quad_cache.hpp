@@ -0,0 +1,131 @@
+#pragma once
+#include "mesher.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Quads of chunks that were meshed before, by content.
+//
+// A chunk's quads are chunk-local and only depend on its merge keys and on the one layer of each
+// adjacent chunk that touches it, so two chunks where those are the same mesh to the same quads.
+// Flat ground, filled-in underground and repeated shapes hit, and skip generate_quads_for_chunk.
+// Entries are found by the 64-bit hash of that content and keep the content itself (560 bytes), a
+// hit compares it, so two chunks whose hashes collide never get each other's quads.
+// Entries are kept in an LRU list per shard, the shards keep parallel meshing from queueing on one lock.
+//
+// Safe to call from several threads at once.
+struct Quad_Cache {
+	static constexpr int shard_count = 16;
+
+	size_t const max_entries; // over all shards
+
+	Quad_Cache(size_t max_entries = 1 << 16) : max_entries(max_entries) {}
+
+	// Everything the quads of a chunk depend on.
+	struct Key {
+		fs::u8   keys[8*8*8]; // as from chunk_keys
+		uint64_t layers[6];   // boundary layer of each neighbor (rows are y*8+z, bits are x): below, above, -x, +x, -z, +z
+
+		auto operator==(Key const& other) const -> bool { return memcmp(this, &other, sizeof(Key)) == 0; }
+
+		auto hash() const -> uint64_t {
+			uint64_t h = 0x2545F4914F6CDD1Dull;
+			auto mix = [&h](uint64_t word) {
+				word *= 0x87C37B91114253D5ull;
+				word  = (word << 31) | (word >> 33);
+				h ^= word * 0x4CF5AD432745937Full;
+				h  = ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+			};
+			for (int i = 0; i < 8*8*8; i += 8) {
+				uint64_t word;
+				memcpy(&word, keys + i, 8);
+				mix(word);
+			}
+			for (auto layer : layers) mix(layer);
+
+			// final avalanche, the low bits pick the shard
+			h ^= h >> 33; h *= 0xFF51AFD7ED558CCDull;
+			h ^= h >> 33; h *= 0xC4CEB9FE1A85EC53ull;
+			h ^= h >> 33;
+			return h;
+		}
+	};
+	static_assert(sizeof(Key) == 8*8*8 + 6 * sizeof(uint64_t)); // no padding, compared with memcmp
+
+	// `keys` as from chunk_keys.
+	static auto chunk_key(fs::u8 const keys[8*8*8], adjacent_chunks const& adjacent, Key& key) -> void {
+		memcpy(key.keys, keys, sizeof(key.keys));
+		auto& layers = key.layers;
+		memset(layers, 0, sizeof(layers));
+		memcpy(&layers[0], adjacent.pos[1] + 56, 8); // below, its top layer
+		memcpy(&layers[1], adjacent.neg[1],      8); // above, its bottom layer
+		for (int row = 0; row < 64; ++row) {
+			layers[2] |= uint64_t((adjacent.pos[0][row] >> 7) & 1) << row; // -x, its x = 7 side
+			layers[3] |= uint64_t( adjacent.neg[0][row]       & 1) << row; // +x, its x = 0 side
+		}
+		for (int y = 0; y < 8; ++y) {
+			layers[4] |= uint64_t(adjacent.pos[2][y*8 + 7]) << (y * 8); // -z, its z = 7 side
+			layers[5] |= uint64_t(adjacent.neg[2][y*8    ]) << (y * 8); // +z, its z = 0 side
+		}
+	}
+
+	// Copies the cached quads into `quads`, false when `key` is not cached. `hash` is key.hash().
+	auto find(Key const& key, uint64_t hash, std::vector<quad>& quads) -> bool {
+		auto& shard = shards[hash % shard_count];
+		{
+			std::scoped_lock lock{shard.mutex};
+			auto it = shard.entries.find(hash);
+			if (it != shard.entries.end() && it->second.key == key) {
+				shard.lru.splice(shard.lru.begin(), shard.lru, it->second.position);
+				quads = it->second.quads;
+				hits += 1;
+				quads_reused += int64_t(quads.size());
+				return true;
+			}
+		}
+		misses += 1;
+		return false;
+	}
+
+	auto insert(Key const& key, uint64_t hash, std::vector<quad> const& quads) -> void {
+		auto& shard = shards[hash % shard_count];
+		std::scoped_lock lock{shard.mutex};
+		auto it = shard.entries.find(hash);
+		if (it != shard.entries.end()) {
+			if (it->second.key == key) return; // two threads meshed the same chunk at once
+			// a different chunk with the same hash, the newer one takes the slot
+			it->second.key   = key;
+			it->second.quads = quads;
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second.position);
+			return;
+		}
+		shard.lru.push_front(hash);
+		shard.entries.emplace(hash, Entry{ key, quads, shard.lru.begin() });
+		while (shard.entries.size() > max_entries / shard_count) {
+			shard.entries.erase(shard.lru.back());
+			shard.lru.pop_back();
+		}
+	}
+
+	// statistics, for the debug overlay
+	std::atomic<int64_t> hits         = 0;
+	std::atomic<int64_t> misses       = 0;
+	std::atomic<int64_t> quads_reused = 0; // quads that came out of the cache instead of the mesher
+
+private:
+	struct Entry {
+		Key                           key;
+		std::vector<quad>             quads;
+		std::list<uint64_t>::iterator position;
+	};
+	struct Shard {
+		std::mutex mutex;
+		std::list<uint64_t> lru; // front is most recently used
+		std::unordered_map<uint64_t, Entry> entries;
+	};
+	Shard shards[shard_count];
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <vector>
+
+// What a raycast needs from a column: the 8x8x8 bitmasks (64 bytes each, row y*8+z holds bits
+// for x) of sections [bottom, bottom + section_count), world section cy at ring slot cy mod section_count.
+struct Raycast_Column {
+	uint8_t const* masks = nullptr; // null when the column is not loaded, rays stop there
+	int      section_count = 0;
+	int      bottom = 0;         // lowest world section held
+	uint32_t empty_sections = 0; // bit per ring slot, set when the section is all air
+};
+
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;    // does not need to be normalized
+	float     max_distance; // in units of `direction`
+};
+
+struct Ray_Hit {
+	bool       hit = false;
+	glm::ivec3 voxel;    // the solid voxel that was hit
+	glm::ivec3 normal;   // face that was entered, voxel + normal is the empty voxel in front of it
+	float      distance; // along the ray, in units of `direction`
+};
+
+// Bit i set when byte i of `x` is not zero.
+inline auto nonzero_bytes(uint64_t x) -> uint8_t {
+	x |= x >> 4; x |= x >> 2; x |= x >> 1;
+	return uint8_t(((x & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56);
+}
+
+// How many clear bits follow bit i of `solid` in the direction of `step`, up to the end of the byte.
+inline auto empty_ahead(uint8_t solid, int i, int step) -> int {
+	if (step > 0) return std::countr_zero((solid | 0x100u) >> (i + 1));
+	return std::countl_zero(uint16_t(((solid << 8) | 0x80u) << (8 - i)));
+}
+
+// 3D DDA through the voxel grid (Amanatides & Woo). Inside sections with solid voxels every step
+// is one voxel and one bit test, except where the ray is in air: a voxel layer of the section
+// without solid voxels (a 64-bit word of the mask, little-endian, its bytes are the rows) is crossed
+// in one step together with the empty layers after it, and for rays that run along the layers an
+// empty row together with the empty rows after it. An 8x8x8 section that is known to be empty is
+// crossed in a single step as well. Rays stop where the column's sections end, above or below.
+// `lookup(cx, cz)` returns the Raycast_Column at chunk coordinates (cx, cz), it is only called
+// when the ray enters a new column.
+template <typename Column_Lookup>
+auto raycast(Ray const& ray, Column_Lookup&& lookup) -> Ray_Hit {
+	Ray_Hit result;
+	glm::vec3 const& o = ray.origin;
+	glm::vec3 const& d = ray.direction;
+
+	glm::ivec3 voxel = glm::ivec3(glm::floor(o));
+	glm::ivec3 step;
+	glm::vec3  t_delta, t_max, inverse; // inverse: 1 / direction, for the jumps
+	for (int a = 0; a < 3; ++a) {
+		constexpr float inf = std::numeric_limits<float>::infinity();
+		step[a]    = (d[a] > 0.0f) - (d[a] < 0.0f);
+		inverse[a] = 1.0f / d[a];
+		t_delta[a] = (d[a] != 0.0f) ? std::abs(inverse[a]) : inf;
+		float boundary = float(voxel[a] + (step[a] > 0));
+		t_max[a]   = (d[a] != 0.0f) ? (boundary - o[a]) / d[a] : inf;
+	}
+
+	// a ray that crosses a voxel layer in fewer than two voxels gains nothing from skipping rows in it
+	bool skip_rows = std::max(std::abs(d.x), std::abs(d.z)) >= 2.0f * std::abs(d.y);
+
+	Raycast_Column column;
+	int column_x = std::numeric_limits<int>::min(), column_z = 0;
+	int section_y = std::numeric_limits<int>::min(); // section `section_empty` and `slot` are for
+	bool section_empty = true;
+	int slot = 0;
+	glm::ivec3 normal = {};
+	float t = 0.0f;
+
+	while (t <= ray.max_distance) {
+		int cx = voxel.x >> 3, cz = voxel.z >> 3;
+		if (cx != column_x || cz != column_z) {
+			column = lookup(cx, cz);
+			column_x = cx; column_z = cz;
+			section_y = std::numeric_limits<int>::min();
+			if (!column.masks) break;
+		}
+
+		int cy = voxel.y >> 3;
+		if (cy < column.bottom || cy >= column.bottom + column.section_count) break; // nothing loaded there
+		if (cy != section_y) {
+			section_y = cy;
+			slot = cy % column.section_count;
+			slot += column.section_count * (slot < 0);
+			section_empty = (column.empty_sections >> slot) & 1;
+		}
+
+		// the empty box in front of the ray: its section, its voxel layer and the empty ones after it,
+		// or its row and the empty ones after it in the layer; none when the row has solid voxels.
+		// Only the faces ahead of the ray matter, the layer and row runs only narrow those.
+		glm::ivec3 low = { cx * 8, cy * 8, cz * 8 }, high = low + glm::ivec3(7);
+		bool empty = section_empty;
+		if (!section_empty) {
+			uint8_t const* section = column.masks + slot * 64;
+			int x = voxel.x & 7, y = voxel.y & 7, z = voxel.z & 7;
+			uint64_t layer;
+			memcpy(&layer, section + y * 8, sizeof(layer));
+			uint8_t row = uint8_t(layer >> (z * 8));
+			if ((row >> x) & 1) {
+				result = { true, voxel, normal, t };
+				return result;
+			}
+			if (layer == 0) {
+				uint64_t layers[8];
+				memcpy(layers, section, sizeof(layers));
+				uint8_t solid_layers = 0;
+				for (int l = 0; l < 8; ++l) solid_layers |= uint8_t(layers[l] != 0) << l;
+				int run = empty_ahead(solid_layers, y, step.y);
+				if (step.y > 0) high.y = voxel.y + run;
+				else            low.y  = voxel.y - run;
+				empty = true;
+			}
+			else if (row == 0 && skip_rows) {
+				int run = empty_ahead(nonzero_bytes(layer), z, step.z);
+				if (step.z > 0) high.z = voxel.z + run;
+				else            low.z  = voxel.z - run;
+				low.y = high.y = voxel.y;
+				empty = true;
+			}
+		}
+
+		int a;
+		if (empty) {
+			// jump straight to the face where the ray leaves the box
+			constexpr float inf = std::numeric_limits<float>::infinity();
+			glm::vec3 t_exit;
+			for (int i = 0; i < 3; ++i)
+				t_exit[i] = (step[i] != 0) ? (float(step[i] > 0 ? high[i] + 1 : low[i]) - o[i]) * inverse[i] : inf;
+			a = (t_exit.x < t_exit.y) ? ((t_exit.x < t_exit.z) ? 0 : 2) : ((t_exit.y < t_exit.z) ? 1 : 2);
+			t = t_exit[a];
+			for (int i = 0; i < 3; ++i) {
+				if (i == a) voxel[i] = (step[i] > 0) ? high[i] + 1 : low[i] - 1;
+				else {
+					float p = o[i] + d[i] * t;
+					int   v = int(p) - (p < float(int(p))); // floor, without the library call
+					voxel[i] = std::clamp(v, low[i], high[i]);
+				}
+				t_max[i] = (step[i] != 0) ? (float(voxel[i] + (step[i] > 0)) - o[i]) * inverse[i] : inf;
+			}
+		}
+		else {
+			// advance to the next voxel along the axis whose boundary is closest
+			a = (t_max.x < t_max.y) ? ((t_max.x < t_max.z) ? 0 : 2) : ((t_max.y < t_max.z) ? 1 : 2);
+			t = t_max[a];
+			t_max[a] += t_delta[a];
+			voxel[a] += step[a];
+		}
+		normal = {};
+		normal[a] = -step[a];
+	}
+	result.distance = t;
+	return result;
+}
+
+// Same as calling `raycast` for each ray, traced on every core in blocks of neighboring rays. A block
+// keeps the columns it looked up in a small direct-mapped cache, rays from around the same origin
+// cross the same columns and mostly skip `lookup`, which has to be safe to call from several threads.
+template <typename Column_Lookup>
+auto raycast_batch(Ray const* rays, int count, Ray_Hit* hits, Column_Lookup&& lookup) -> void {
+	constexpr int block_size = 256;
+	std::vector<int> blocks((count + block_size - 1) / block_size);
+	for (size_t b = 0; b < blocks.size(); ++b) blocks[b] = int(b);
+
+	std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](int block) {
+		struct Cached {
+			int x = std::numeric_limits<int>::min(), z = 0;
+			Raycast_Column column;
+		};
+		Cached cache[64];
+		auto cached_lookup = [&](int cx, int cz) -> Raycast_Column {
+			auto& entry = cache[(cx & 7) | (cz & 7) << 3];
+			if (entry.x != cx || entry.z != cz) {
+				entry.column = lookup(cx, cz);
+				entry.x = cx; entry.z = cz;
+			}
+			return entry.column;
+		};
+		int last = std::min(count, (block + 1) * block_size);
+		for (int i = block * block_size; i < last; ++i)
+			hits[i] = raycast(rays[i], cached_lookup);
+	});
+}
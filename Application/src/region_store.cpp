@@ -0,0 +1,271 @@
+#include "region_store.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	constexpr uint32_t region_magic    = 0x47525856; // "VXRG"
+	constexpr uint32_t region_version  = 2;          // 1 stored whole 16 section columns
+	constexpr size_t   header_bytes    = 4096;
+	constexpr int      region_sections = Region_Store::region_size * Region_Store::region_size * Region_Store::region_height;
+
+	struct Region_Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t section_bytes;
+		uint8_t  present[region_sections / 8]; // a bit per section, set once its mask has been written
+	};
+	static_assert(sizeof(Region_Header) <= header_bytes);
+
+	// section (cx, cy, cz) within its region, sections of one layer are contiguous
+	auto section_index(int cx, int cy, int cz) -> int {
+		constexpr int size = Region_Store::region_size;
+		return ((cy & (Region_Store::region_height - 1)) * size + (cz & (size - 1))) * size + (cx & (size - 1));
+	}
+
+	// 21 bits per region coordinate, the top bit tells the type file from the masks
+	auto region_key(int rx, int ry, int rz, bool types = false) -> uint64_t {
+		constexpr uint64_t mask = (uint64_t(1) << 21) - 1;
+		return ((uint64_t(uint32_t(rx)) & mask) << 42) | ((uint64_t(uint32_t(ry)) & mask) << 21) | (uint64_t(uint32_t(rz)) & mask)
+			| (uint64_t(types) << 63);
+	}
+}
+
+struct Region_Store::Region {
+	uint8_t* base = nullptr; // null when the file could not be mapped
+	size_t   size = 0;
+#if defined(_WIN32)
+	HANDLE file    = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+#else
+	int fd = -1;
+#endif
+
+	// Stored sections reach the disk before the region is unmapped (evicted, or the store closed),
+	// not just whenever the OS gets to them, so a crash of the machine later does not lose them.
+	~Region() {
+#if defined(_WIN32)
+		if (base && dirty) {
+			FlushViewOfFile(base, 0);
+			FlushFileBuffers(file);
+		}
+		if (base)    UnmapViewOfFile(base);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+		if (base && dirty) msync(base, size, MS_SYNC);
+		if (base)    munmap(base, size);
+		if (fd >= 0) close(fd);
+#endif
+	}
+
+	// Maps all `size` bytes of the file. With `create` it is mapped for writing, a missing file is
+	// created and a short one grown, new bytes read as zeros; without, it is opened and mapped
+	// read-only, both fail and nothing on disk changes.
+	auto map(std::filesystem::path const& path, bool create) -> bool {
+#if defined(_WIN32)
+		DWORD access = create ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+		file = CreateFileW(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER file_size;
+		if (!create && (!GetFileSizeEx(file, &file_size) || uint64_t(file_size.QuadPart) < size)) return false;
+		// grows the file to `size` if it is shorter
+		mapping = CreateFileMappingW(file, NULL, create ? PAGE_READWRITE : PAGE_READONLY, DWORD(uint64_t(size) >> 32), DWORD(size), NULL);
+		if (!mapping) return false;
+		base = (uint8_t*)MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+		return base != nullptr;
+#else
+		fd = open(path.c_str(), create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) return false;
+		if (size_t(st.st_size) < size && (!create || ftruncate(fd, off_t(size)) != 0)) return false;
+		void* p = mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) return false;
+		base = (uint8_t*)p;
+		return true;
+#endif
+	}
+
+	auto header() -> Region_Header* { return (Region_Header*)base; }
+
+	bool created = false; // opened to store into (mapped writable), a region that failed to map then stays unmapped
+	std::atomic<bool> dirty = false; // a section was stored since it was mapped
+};
+
+Region_Store::Region_Store(std::filesystem::path directory, size_t max_open_regions)
+	: directory(std::move(directory)), max_open_regions(max_open_regions)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(this->directory, ec);
+}
+
+Region_Store::~Region_Store() = default;
+
+auto Region_Store::region_path(int rx, int ry, int rz, bool types) const -> std::filesystem::path {
+	return directory / ((types ? "t." : "r.") + std::to_string(rx) + "." + std::to_string(ry) + "." + std::to_string(rz) + ".bin");
+}
+
+auto Region_Store::open_region(int rx, int ry, int rz, bool create, bool types) -> std::shared_ptr<Region> {
+	uint64_t key = region_key(rx, ry, rz, types);
+	size_t bytes = types ? type_bytes : section_bytes;
+
+	// evicted regions are released after the lock, unmapping flushes them
+	std::vector<std::shared_ptr<Region>> evicted;
+	std::scoped_lock lock{mutex};
+	auto it = regions.find(key);
+	if (it != regions.end()) {
+		lru.splice(lru.begin(), lru, it->second.position);
+		auto& cached = it->second.region;
+		// one that was opened to load from, mapped read-only or not there at all, is opened again
+		// for writing by the first store
+		if (cached->created || !create) return cached;
+	}
+
+	auto region = std::make_shared<Region>();
+	region->size = header_bytes + region_sections * bytes;
+	region->created = create;
+	if (region->map(region_path(rx, ry, rz, types), create)) {
+		auto header = region->header();
+		bool valid = header->magic == region_magic && header->version == region_version
+			&& header->section_bytes == uint32_t(bytes);
+		if (!valid && create) {
+			// new file, or written by an incompatible version: start the region over
+			memset(header, 0, sizeof(Region_Header));
+			header->magic         = region_magic;
+			header->version       = region_version;
+			header->section_bytes = uint32_t(bytes);
+		}
+		else if (!valid) {
+			// loads leave it alone, it has nothing for them
+			region = std::make_shared<Region>();
+		}
+	}
+	else if (!create) region = std::make_shared<Region>();
+	// a region that failed to map stays null: loads miss, and stores are dropped once creating it failed
+
+	// regions are dropped from the map here but only unmapped once no caller holds them
+	if (it != regions.end()) {
+		it->second.region = region;
+		return region;
+	}
+	lru.push_front(key);
+	regions.emplace(key, Entry{ region, lru.begin() });
+	while (regions.size() > max_open_regions) {
+		evicted.push_back(std::move(regions[lru.back()].region));
+		regions.erase(lru.back());
+		lru.pop_back();
+	}
+	return region;
+}
+
+auto Region_Store::load(int cx, int cz, Terrain_Column& column) -> uint32_t {
+	uint32_t loaded = 0;
+	std::shared_ptr<Region> region;
+	for (int i = 0; i < column.section_count; ++i) {
+		int cy = column.section_y + i;
+		if (!region || (cy & (region_height - 1)) == 0)
+			region = open_region(cx >> region_shift, cy >> region_height_shift, cz >> region_shift, false);
+		if (!region->base) continue;
+
+		int index = section_index(cx, cy, cz);
+		auto bits = std::atomic_ref(region->header()->present[index >> 3]).load(std::memory_order_acquire);
+		if (!((bits >> (index & 7)) & 1)) continue;
+
+		memcpy(column.masks + i * section_bytes, region->base + header_bytes + index * section_bytes, section_bytes);
+		loaded |= uint32_t(1) << i;
+	}
+	return loaded;
+}
+
+auto Region_Store::store(int cx, int cz, Terrain_Column const& column, uint32_t sections) -> void {
+	std::shared_ptr<Region> region;
+	for (int i = 0; i < column.section_count; ++i) {
+		int cy = column.section_y + i;
+		if (!region || (cy & (region_height - 1)) == 0)
+			region = open_region(cx >> region_shift, cy >> region_height_shift, cz >> region_shift, true);
+		if (!region->base || !((sections >> i) & 1)) continue;
+
+		int index = section_index(cx, cy, cz);
+		memcpy(region->base + header_bytes + index * section_bytes, column.masks + i * section_bytes, section_bytes);
+		std::atomic_ref(region->header()->present[index >> 3]).fetch_or(uint8_t(1 << (index & 7)), std::memory_order_release);
+		region->dirty = true;
+	}
+}
+
+auto Region_Store::load_types(int cx, int cz, int section_y, int section_count, uint8_t* types, uint32_t sections) -> uint32_t {
+	uint32_t loaded = 0;
+	std::shared_ptr<Region> region;
+	int region_y = 0;
+	for (int i = 0; i < section_count; ++i) {
+		int cy = section_y + i;
+		if (!((sections >> i) & 1)) continue;
+		if (!region || (cy >> region_height_shift) != region_y) {
+			region_y = cy >> region_height_shift;
+			region = open_region(cx >> region_shift, region_y, cz >> region_shift, false, true);
+		}
+		if (!region->base) continue;
+
+		int index = section_index(cx, cy, cz);
+		auto bits = std::atomic_ref(region->header()->present[index >> 3]).load(std::memory_order_acquire);
+		if (!((bits >> (index & 7)) & 1)) continue;
+
+		memcpy(types + i * type_bytes, region->base + header_bytes + index * type_bytes, type_bytes);
+		loaded |= uint32_t(1) << i;
+	}
+	return loaded;
+}
+
+auto Region_Store::store_types(int cx, int cz, int section_y, int section_count, uint8_t const* types, uint32_t sections) -> void {
+	std::shared_ptr<Region> region;
+	int region_y = 0;
+	for (int i = 0; i < section_count; ++i) {
+		int cy = section_y + i;
+		if (!((sections >> i) & 1)) continue; // only regions with something to store get a type file
+		if (!region || (cy >> region_height_shift) != region_y) {
+			region_y = cy >> region_height_shift;
+			region = open_region(cx >> region_shift, region_y, cz >> region_shift, true, true);
+		}
+		if (!region->base) continue;
+
+		int index = section_index(cx, cy, cz);
+		memcpy(region->base + header_bytes + index * type_bytes, types + i * type_bytes, type_bytes);
+		std::atomic_ref(region->header()->present[index >> 3]).fetch_or(uint8_t(1 << (index & 7)), std::memory_order_release);
+		region->dirty = true;
+	}
+}
+
+auto Region_Store::prefetch(int cx0, int cz0, int cx1, int cz1, int cy0, int cy1) -> void {
+	if (cx0 >= cx1 || cz0 >= cz1 || cy0 >= cy1) return;
+	for (int ry = cy0 >> region_height_shift; ry <= (cy1 - 1) >> region_height_shift; ++ry)
+	for (int rz = cz0 >> region_shift; rz <= (cz1 - 1) >> region_shift; ++rz)
+	for (int rx = cx0 >> region_shift; rx <= (cx1 - 1) >> region_shift; ++rx) {
+		{
+			std::scoped_lock lock{mutex};
+			if (regions.contains(region_key(rx, ry, rz))) continue; // already mapped, and touched recently
+		}
+		std::error_code ec;
+		if (!std::filesystem::exists(region_path(rx, ry, rz), ec)) continue;
+
+		auto region = open_region(rx, ry, rz, false);
+		if (!region->base) continue;
+#if defined(_WIN32)
+		WIN32_MEMORY_RANGE_ENTRY range = { region->base, region->size };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		madvise(region->base, region->size, MADV_WILLNEED);
+#endif
+	}
+}
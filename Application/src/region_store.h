@@ -0,0 +1,76 @@
+#pragma once
+#include "block_types.h"
+#include "terrain.h"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// On-disk section storage, one file per 32x32 columns by 16 sections vertically.
+//
+// A region file has a fixed size: a 4 KiB header (magic, layout, one presence bit per section)
+// followed by 32*16*32 section masks of 64 bytes at fixed offsets. Files only exist where
+// sections were stored, so a world with no height limit only takes disk where it was visited.
+// Files are memory mapped, so loading a section is a memcpy out of the page cache and storing
+// one is a memcpy into it; the OS writes pages back.
+//
+// The block types of edited sections go in a second file per region laid out the same way, with a
+// serialized Block_Section per section. Only edits create it, untouched sections get their types
+// from their shape again when they are loaded.
+//
+// Safe to call from several threads at once.
+struct Region_Store {
+	static constexpr int region_shift        = 5;
+	static constexpr int region_size         = 1 << region_shift;        // columns per region side
+	static constexpr int region_height_shift = 4;
+	static constexpr int region_height       = 1 << region_height_shift; // sections per region, vertically
+	static constexpr size_t section_bytes    = 64;
+	static constexpr size_t type_bytes       = Block_Section::serialized_bytes;
+
+	// `directory` is created if needed.
+	Region_Store(std::filesystem::path directory, size_t max_open_regions = 64);
+	~Region_Store();
+
+	Region_Store(Region_Store const&) = delete;
+
+	// Sections [column.section_y, column.section_y + column.section_count) of column (cx, cz) in chunk
+	// coordinates, at most 32 of them. Returns a bitmask with bit i set when masks section i was
+	// stored before and has been loaded; the other sections are left untouched. Never creates files.
+	auto load(int cx, int cz, Terrain_Column& column) -> uint32_t;
+
+	// Writes the sections of `column` whose bit is set in `sections`, creating their region files.
+	auto store(int cx, int cz, Terrain_Column const& column, uint32_t sections = ~uint32_t(0)) -> void;
+
+	// Serialized block types (type_bytes each, `types` holds one per section of the run) of the run of
+	// `section_count` sections from world section `section_y` in column (cx, cz). Only sections whose
+	// bit is set in `sections` are looked at; returns a bit for each that had types stored.
+	auto load_types(int cx, int cz, int section_y, int section_count, uint8_t* types, uint32_t sections) -> uint32_t;
+
+	// Writes the types of the sections whose bit is set in `sections`, creating their type files.
+	auto store_types(int cx, int cz, int section_y, int section_count, uint8_t const* types, uint32_t sections) -> void;
+
+	// Asks the OS to read every existing region overlapping columns [c0, c1) and sections [cy0, cy1)
+	// into memory, so later loads there do not stall on the disk. Does not create files.
+	auto prefetch(int cx0, int cz0, int cx1, int cz1, int cy0, int cy1) -> void;
+
+	std::filesystem::path const directory;
+	size_t const max_open_regions;
+
+private:
+	struct Region; // an open, mapped region file
+
+	// Without `create` a region with no file yet comes back unmapped, until a store creates it.
+	// `types` opens the region's block type file instead of its masks.
+	auto open_region(int rx, int ry, int rz, bool create, bool types = false) -> std::shared_ptr<Region>;
+	auto region_path(int rx, int ry, int rz, bool types = false) const -> std::filesystem::path;
+
+	std::mutex mutex;
+	std::list<uint64_t> lru; // front is most recently used
+	struct Entry {
+		std::shared_ptr<Region>       region;
+		std::list<uint64_t>::iterator position;
+	};
+	std::unordered_map<uint64_t, Entry> regions;
+};
@@ -0,0 +1,229 @@
+#include "terrain.h"
+#include "noise.h"
+#include "noise_cache.h"
+#include "density.h"
+#include "config.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+auto update_column_bounds(Terrain_Column& column) -> void {
+	int height = column.section_count * 8;
+	auto layer = [&](int y) -> uint64_t {
+		uint64_t bits;
+		memcpy(&bits, column.masks + (y / 8) * 64 + (y % 8) * 8, sizeof(bits));
+		return bits;
+	};
+
+	int lowest = 0;
+	while (lowest < height && layer(lowest) == ~uint64_t(0)) ++lowest;
+
+	int highest = height;
+	while (highest > lowest && layer(highest - 1) == 0) --highest;
+
+	column.min_height = (uint16_t)lowest;
+	column.max_height = (uint16_t)highest;
+}
+
+// Heights are in units of 64 voxels, everything below the surface is solid however deep the run is.
+static auto fill_from_height_field(float const height_field[64], Terrain_Column& column) -> void {
+	int height = column.section_count * 8;
+	int bottom = column.section_y * 8;
+
+	// float(y)/64 < height  <=>  y < height*64 (exact, 64 is a power of two),
+	// so each location is solid below world layer ceil(height*64), counted here from the run's bottom
+	int solid_layers[64];
+	int lowest = height, highest = 0;
+	for (int i = 0; i < 64; ++i) {
+		solid_layers[i] = std::clamp((int)std::ceil(height_field[i] * 64.0f) - bottom, 0, height);
+		lowest  = std::min(lowest , solid_layers[i]);
+		highest = std::max(highest, solid_layers[i]);
+	}
+	column.min_height = (uint16_t)lowest;
+	column.max_height = (uint16_t)highest;
+
+	for (int cy = 0; cy < column.section_count; ++cy) {
+		int base = cy * 8;
+		if (base >= highest) break; // this and everything above stays empty
+
+		uint8_t* block_mask = column.masks + cy * 64;
+		if (base + 8 <= lowest) {
+			memset(block_mask, 0xFF, 64);
+			continue;
+		}
+		for (int z = 0; z < 8; ++z) {
+			int const* row = solid_layers + z*8;
+			for (int y = 0; y < 8; ++y) {
+				uint8_t bits = 0;
+				for (int x = 0; x < 8; ++x)
+					bits |= uint8_t(row[x] > base + y) << x;
+				block_mask[y*8 + z] = bits;
+			}
+		}
+	}
+}
+
+// amplitude * stb_perlin_ridge_noise3(x * scale, z * scale, y, ...)
+struct Ridge_Height {
+	Ridge_Params params;
+	float amplitude = 1.0f;
+	std::unique_ptr<Noise_Cache> cache;
+
+	Ridge_Height(Ridge_Params const& params, float amplitude) : params(params), amplitude(amplitude) {
+		if (use_noise_cache)
+			cache = std::make_unique<Noise_Cache>(params, noise_cache_samples_per_cell, (size_t)noise_cache_max_tiles);
+	}
+
+	auto operator()(int x0, int z0, float out[64]) -> void {
+		if (cache) {
+			cache->height_field(x0, z0, out);
+		}
+		else {
+			float x[64], z[64], y[64];
+			for (int j = 0; j < 8; ++j)
+			for (int i = 0; i < 8; ++i) {
+				x[j*8 + i] = float(x0 + i) * params.scale;
+				z[j*8 + i] = float(z0 + j) * params.scale;
+				y[j*8 + i] = params.y;
+			}
+			noise::ridge_noise3(x, z, y, 64, params.lacunarity, params.gain, params.offset, params.octaves, out);
+		}
+		if (amplitude != 1.0f)
+			for (int i = 0; i < 64; ++i) out[i] *= amplitude;
+	}
+};
+
+// base + amplitude * stb_perlin_fbm_noise3(x * scale, z * scale, y, ...)
+struct Fbm_Height {
+	float scale, y;
+	float lacunarity, gain;
+	int   octaves;
+	float base, amplitude;
+
+	auto operator()(int x0, int z0, float out[64]) -> void {
+		float px[64], pz[64], py[64];
+		for (int j = 0; j < 8; ++j)
+		for (int i = 0; i < 8; ++i) {
+			px[j*8 + i] = float(x0 + i) * scale;
+			pz[j*8 + i] = float(z0 + j) * scale;
+			py[j*8 + i] = y;
+		}
+		noise::fbm_noise3(px, pz, py, 64, lacunarity, gain, octaves, out);
+		for (int i = 0; i < 64; ++i) out[i] = base + amplitude * out[i];
+	}
+};
+
+template <typename Height>
+struct Heightfield_Generator final : Terrain_Generator {
+	const char* generator_name;
+	Height height;
+
+	Heightfield_Generator(const char* name, Height&& height): generator_name(name), height(std::move(height)) {}
+
+	auto name() const -> const char* override { return generator_name; }
+
+	auto noise_cache() -> Noise_Cache* override {
+		if constexpr (std::is_same_v<Height, Ridge_Height>) return height.cache.get();
+		else return nullptr;
+	}
+
+protected:
+	auto fill(int x0, int z0, Terrain_Column& column) -> void override {
+		float height_field[64];
+		height(x0, z0, height_field);
+		fill_from_height_field(height_field, column);
+	}
+};
+
+// Floating blobs, solid wherever 3D noise is above a threshold.
+struct Density_Generator final : Terrain_Generator {
+	auto name() const -> const char* override { return "blobs"; }
+
+protected:
+	auto fill(int x0, int z0, Terrain_Column& column) -> void override {
+		Density_Params params;
+		params.lattice_step = density_lattice_step;
+		fill_density_column(x0, column.section_y * 8, z0, params, column.masks, column.section_count);
+		update_column_bounds(column);
+	}
+};
+
+// Mountains with caves: the heightfield decides the surface, 3D noise carves tunnels below it.
+struct Hybrid_Generator final : Terrain_Generator {
+	Ridge_Height surface{Ridge_Params{}, 1.0f};
+
+	auto name() const -> const char* override { return "caves"; }
+	auto noise_cache() -> Noise_Cache* override { return surface.cache.get(); }
+
+protected:
+	auto fill(int x0, int z0, Terrain_Column& column) -> void override {
+		float height_field[64];
+		surface(x0, z0, height_field);
+		fill_from_height_field(height_field, column);
+
+		Density_Params caves;
+		caves.scale        = 1.0f / 32.0f;
+		caves.threshold    = 0.3f;
+		caves.lattice_step = density_lattice_step;
+
+		// only sections that have solid voxels can be carved, tunnels run down as far as the world goes
+		int sections = (column.max_height + 7) / 8;
+		thread_local uint8_t cave_masks[64 * 64];
+		sections = std::min(sections, 64);
+		memset(cave_masks, 0, size_t(sections) * 64);
+		fill_density_column(x0, column.section_y * 8, z0, caves, cave_masks, sections);
+
+		for (int i = 0; i < sections * 64; ++i)
+			column.masks[i] &= uint8_t(~cave_masks[i]);
+		update_column_bounds(column);
+	}
+};
+
+static const char* const generator_names[] = {
+	"mountains",
+	"spiky_mountains",
+	"bumpy",
+	"flat",
+	"blobs",
+	"caves",
+};
+
+auto terrain_generator_names() -> std::span<const char* const> {
+	return generator_names;
+}
+
+auto create_terrain_generator(const char* name, int seed) -> std::unique_ptr<Terrain_Generator> {
+	auto is = [name](const char* s) { return strcmp(name, s) == 0; };
+
+	std::unique_ptr<Terrain_Generator> generator;
+	if (is("mountains"))
+		generator = std::make_unique<Heightfield_Generator<Ridge_Height>>("mountains", Ridge_Height{Ridge_Params{}, 1.0f});
+	else if (is("spiky_mountains")) {
+		Ridge_Params params;
+		params.scale = 1.0f / 64.0f;
+		generator = std::make_unique<Heightfield_Generator<Ridge_Height>>("spiky_mountains", Ridge_Height{params, 2.0f});
+	}
+	else if (is("bumpy"))
+		generator = std::make_unique<Heightfield_Generator<Fbm_Height>>("bumpy", Fbm_Height{1.0f / 256.0f, 0.435f, 2.0f, 0.5f, 8, 1.0f, 0.7f});
+	else if (is("flat"))
+		generator = std::make_unique<Heightfield_Generator<Fbm_Height>>("flat", Fbm_Height{1.0f / 64.0f, 0.435f, 2.0f, 0.3f, 8, 0.5f, 0.2f});
+	else if (is("blobs"))
+		generator = std::make_unique<Density_Generator>();
+	else if (is("caves"))
+		generator = std::make_unique<Hybrid_Generator>();
+	else
+		return nullptr;
+
+	generator->seed = seed;
+	if (seed != 0) {
+		// integer hash of the seed, offsets stay below 16384 voxels to keep noise coordinates
+		// small enough for float precision (stb_perlin repeats every 256 lattice cells anyway)
+		uint32_t h = uint32_t(seed) * 0x9E3779B1u;
+		h ^= h >> 15; h *= 0x85EBCA77u; h ^= h >> 13;
+		generator->seed_offset_x = int( h        & 0x7FF) * 8;
+		generator->seed_offset_z = int((h >> 11) & 0x7FF) * 8;
+	}
+	return generator;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+
+struct Noise_Cache;
+
+// A vertical run of terrain: `section_count` stacked 8x8x8 bitmasks (64 bytes each, row y*8+z holds
+// bits for x) starting at world section `section_y`, and its height bounds in voxel layers counted
+// from the bottom of the run. The world has no height limit, any run can be generated on its own.
+struct Terrain_Column {
+	uint8_t* masks;
+	int      section_count;
+	uint16_t min_height; // every voxel layer below is completely solid
+	uint16_t max_height; // every voxel layer at or above is completely empty
+	int      section_y = 0; // world section of masks[0], its lowest voxel is at y = section_y * 8
+};
+
+// World type, picked at runtime by name (see `create_terrain_generator`).
+// The virtual call is per column; every generator is its own class, so the per-voxel loops
+// are compiled for the exact noise it uses.
+struct Terrain_Generator {
+	virtual ~Terrain_Generator() = default;
+
+	virtual auto name() const -> const char* = 0;
+
+	// Fills a zeroed run whose lowest voxel is at world location (x0, column.section_y * 8, z0).
+	// Safe to call from several threads at once.
+	auto generate(int x0, int z0, Terrain_Column& column) -> void {
+		fill(x0 + seed_offset_x, z0 + seed_offset_z, column);
+	}
+
+	// The heightfield noise cache, if this generator uses one.
+	virtual auto noise_cache() -> Noise_Cache* { return nullptr; }
+
+	int seed = 0;
+
+protected:
+	virtual auto fill(int x0, int z0, Terrain_Column& column) -> void = 0;
+
+private:
+	friend auto create_terrain_generator(const char* name, int seed) -> std::unique_ptr<Terrain_Generator>;
+
+	// the seed picks a different part of the noise, in whole columns so lattices stay aligned
+	int seed_offset_x = 0;
+	int seed_offset_z = 0;
+};
+
+// Names accepted by `create_terrain_generator`, in the order they are cycled through.
+auto terrain_generator_names() -> std::span<const char* const>;
+
+// Returns nullptr for an unknown name.
+auto create_terrain_generator(const char* name, int seed) -> std::unique_ptr<Terrain_Generator>;
+
+// Recomputes min_height/max_height by scanning the voxel layers.
+auto update_column_bounds(Terrain_Column& column) -> void;